@@ -99,16 +99,19 @@ else
         SRC += $(PLATFORM_COMMON_DIR)/flash_stm32.c
         OPT_DEFS += -DEEPROM_EMU_STM32F303xC
         OPT_DEFS += -DSTM32_EEPROM_ENABLE
+        LDFLAGS += $(PLATFORM_COMMON_DIR)/eeprom_stm32.ld
       else ifeq ($(MCU_SERIES), STM32F1xx)
         SRC += $(PLATFORM_COMMON_DIR)/eeprom_stm32.c
         SRC += $(PLATFORM_COMMON_DIR)/flash_stm32.c
         OPT_DEFS += -DEEPROM_EMU_STM32F103xB
         OPT_DEFS += -DSTM32_EEPROM_ENABLE
+        LDFLAGS += $(PLATFORM_COMMON_DIR)/eeprom_stm32.ld
       else ifeq ($(MCU_SERIES)_$(MCU_LDSCRIPT), STM32F0xx_STM32F072xB)
         SRC += $(PLATFORM_COMMON_DIR)/eeprom_stm32.c
         SRC += $(PLATFORM_COMMON_DIR)/flash_stm32.c
         OPT_DEFS += -DEEPROM_EMU_STM32F072xB
         OPT_DEFS += -DSTM32_EEPROM_ENABLE
+        LDFLAGS += $(PLATFORM_COMMON_DIR)/eeprom_stm32.ld
       else ifneq ($(filter $(MCU_SERIES),STM32L0xx STM32L1xx),)
         OPT_DEFS += -DEEPROM_DRIVER
         COMMON_VPATH += $(DRIVER_PATH)/eeprom
@@ -355,6 +358,11 @@ ifeq ($(strip $(DIP_SWITCH_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/dip_switch.c
 endif
 
+ifeq ($(strip $(SEND_STRING_ASYNC_ENABLE)), yes)
+    OPT_DEFS += -DSEND_STRING_ASYNC_ENABLE
+    SRC += $(QUANTUM_DIR)/send_string_async.c
+endif
+
 VALID_CUSTOM_MATRIX_TYPES:= yes lite no
 
 CUSTOM_MATRIX ?= no
@@ -375,6 +383,7 @@ ifneq ($(strip $(CUSTOM_MATRIX)), yes)
         else
             QUANTUM_SRC += $(QUANTUM_DIR)/matrix.c
         endif
+        QUANTUM_SRC += $(QUANTUM_DIR)/matrix_port_scan.c
     endif
 endif
 
@@ -0,0 +1,369 @@
+/* UART + DMA backend for the split keyboard serial link.
+ *
+ * Implements the drivers/avr/serial.h transaction API on top of the ChibiOS
+ * UART driver, which moves every byte with DMA. The scan loop never waits on
+ * the other half: soft_serial_transaction() queues the exchange and returns
+ * the outcome of the previous one for that transaction id, so results arrive
+ * one call late.
+ *
+ * Please ensure that HAL_USE_UART is TRUE in the halconf.h file and that the
+ * matching STM32_UART_USE_USARTn is TRUE in the mcuconf.h file.
+ *
+ * By default a single wire on SOFT_SERIAL_PIN is used (USART half-duplex
+ * mode, the pin has to be the USART's TX pin). Define
+ * SERIAL_USART_FULL_DUPLEX and SERIAL_USART_RX_PIN to use separate TX and RX
+ * lines crossed between the halves.
+ */
+#include "quantum.h"
+#include "serial.h"
+#include <string.h>
+
+#ifndef SERIAL_USART_DRIVER
+#    define SERIAL_USART_DRIVER UARTD1
+#endif
+
+#ifndef SERIAL_USART_SPEED
+#    define SERIAL_USART_SPEED 921600
+#endif
+
+#ifndef SERIAL_USART_TX_PIN
+#    define SERIAL_USART_TX_PIN SOFT_SERIAL_PIN
+#endif
+
+#ifndef SERIAL_USART_TX_PAL_MODE
+#    define SERIAL_USART_TX_PAL_MODE 7
+#endif
+
+#ifdef SERIAL_USART_FULL_DUPLEX
+#    ifndef SERIAL_USART_RX_PIN
+#        error "SERIAL_USART_FULL_DUPLEX requires SERIAL_USART_RX_PIN"
+#    endif
+#    ifndef SERIAL_USART_RX_PAL_MODE
+#        define SERIAL_USART_RX_PAL_MODE 7
+#    endif
+#endif
+
+// How long the initiator waits for a reply before giving up (ms). The target
+// gives up on a partial request after half of this, so it is listening again
+// before the initiator sends the next one.
+#ifndef SERIAL_USART_TIMEOUT
+#    define SERIAL_USART_TIMEOUT 20
+#endif
+
+#ifdef SERIAL_USART_FULL_DUPLEX
+#    define SERIAL_USART_CR3 0
+#    define SERIAL_ECHO(len) 0
+#else
+#    define SERIAL_USART_CR3 USART_CR3_HDSEL
+// On a single wire everything we send is looped back into our own receiver
+#    define SERIAL_ECHO(len) (len)
+#endif
+
+static SSTD_t *Transaction_table      = NULL;
+static uint8_t Transaction_table_size = 0;
+static bool    is_initiator           = false;
+
+static virtual_timer_t serial_timeout_vt;
+
+typedef enum {
+    SLOT_IDLE,
+    SLOT_QUEUED,
+    SLOT_ACTIVE,
+    SLOT_DONE,
+} slot_state_t;
+
+// Each transaction id has its own DMA buffers, so the DMA never touches the
+// buffers the split transport reads and writes. Requests are snapshotted into
+// tx when queued, replies are copied out of rx on the next call.
+typedef struct {
+    volatile slot_state_t state;
+    volatile uint8_t      done_status;
+    uint8_t               last_status;
+    uint8_t               tx[1 + SERIAL_USART_BUFFER_SIZE];
+    uint8_t               rx[SERIAL_ECHO(1 + SERIAL_USART_BUFFER_SIZE) + SERIAL_USART_BUFFER_SIZE];
+} serial_slot_t;
+
+static serial_slot_t slots[SERIAL_USART_MAX_TRANSACTIONS];
+static int8_t        active_slot = -1;
+static uint8_t       next_slot   = 0;
+static size_t        active_rx_len;
+
+typedef enum {
+    TARGET_HEADER,
+    TARGET_DATA,
+    TARGET_ECHO,
+} target_state_t;
+
+static target_state_t target_state;
+static uint8_t        target_header;
+static uint8_t        target_rx[SERIAL_USART_BUFFER_SIZE];
+static uint8_t        target_tx[SERIAL_USART_BUFFER_SIZE];
+
+static void serial_timeout_cb(void *arg);
+
+// Initiator
+
+static void initiator_start_next_i(void) {
+    active_slot = -1;
+    for (uint8_t n = 0; n < Transaction_table_size; n++) {
+        uint8_t index = (next_slot + n) % Transaction_table_size;
+        if (slots[index].state != SLOT_QUEUED) {
+            continue;
+        }
+
+        SSTD_t *trans = &Transaction_table[index];
+        active_slot   = index;
+        next_slot     = (index + 1) % Transaction_table_size;
+        active_rx_len = SERIAL_ECHO(1 + trans->initiator2target_buffer_size) + trans->target2initiator_buffer_size;
+
+        slots[index].state = SLOT_ACTIVE;
+        if (active_rx_len > 0) {
+            uartStartReceiveI(&SERIAL_USART_DRIVER, active_rx_len, slots[index].rx);
+        }
+        uartStartSendI(&SERIAL_USART_DRIVER, 1 + trans->initiator2target_buffer_size, slots[index].tx);
+        chVTSetI(&serial_timeout_vt, TIME_MS2I(SERIAL_USART_TIMEOUT), serial_timeout_cb, NULL);
+        return;
+    }
+}
+
+static void initiator_complete_i(uint8_t status) {
+    if (active_slot < 0) {
+        return;
+    }
+    chVTResetI(&serial_timeout_vt);
+    slots[active_slot].done_status = status;
+    slots[active_slot].state       = SLOT_DONE;
+    initiator_start_next_i();
+}
+
+static void initiator_abort_i(uint8_t status) {
+    uartStopReceiveI(&SERIAL_USART_DRIVER);
+    uartStopSendI(&SERIAL_USART_DRIVER);
+    initiator_complete_i(status);
+}
+
+// Target
+
+static void target_listen_i(void) {
+    target_state = TARGET_HEADER;
+    uartStartReceiveI(&SERIAL_USART_DRIVER, 1, &target_header);
+}
+
+static void target_reply_i(void) {
+    SSTD_t *trans = &Transaction_table[target_header];
+
+    memcpy(trans->initiator2target_buffer, target_rx, trans->initiator2target_buffer_size);
+    *trans->status = TRANSACTION_ACCEPTED;
+
+    if (trans->target2initiator_buffer_size == 0) {
+        chVTResetI(&serial_timeout_vt);
+        target_listen_i();
+        return;
+    }
+
+    memcpy(target_tx, trans->target2initiator_buffer, trans->target2initiator_buffer_size);
+#ifdef SERIAL_USART_FULL_DUPLEX
+    chVTResetI(&serial_timeout_vt);
+    uartStartSendI(&SERIAL_USART_DRIVER, trans->target2initiator_buffer_size, target_tx);
+    target_listen_i();
+#else
+    // swallow our own reply before listening for the next request
+    target_state = TARGET_ECHO;
+    uartStartReceiveI(&SERIAL_USART_DRIVER, trans->target2initiator_buffer_size, target_rx);
+    uartStartSendI(&SERIAL_USART_DRIVER, trans->target2initiator_buffer_size, target_tx);
+#endif
+}
+
+static void target_rx_i(void) {
+    switch (target_state) {
+        case TARGET_HEADER:
+            if (target_header >= Transaction_table_size) {
+                target_listen_i();
+                break;
+            }
+            chVTSetI(&serial_timeout_vt, TIME_MS2I(SERIAL_USART_TIMEOUT / 2), serial_timeout_cb, NULL);
+            if (Transaction_table[target_header].initiator2target_buffer_size > 0) {
+                target_state = TARGET_DATA;
+                uartStartReceiveI(&SERIAL_USART_DRIVER, Transaction_table[target_header].initiator2target_buffer_size, target_rx);
+            } else {
+                target_reply_i();
+            }
+            break;
+        case TARGET_DATA:
+            target_reply_i();
+            break;
+        case TARGET_ECHO:
+            chVTResetI(&serial_timeout_vt);
+            target_listen_i();
+            break;
+    }
+}
+
+static void target_abort_i(void) {
+    uartStopReceiveI(&SERIAL_USART_DRIVER);
+    uartStopSendI(&SERIAL_USART_DRIVER);
+    chVTResetI(&serial_timeout_vt);
+    target_listen_i();
+}
+
+// Driver callbacks, all run in interrupt context
+
+static void serial_timeout_cb(void *arg) {
+    (void)arg;
+    osalSysLockFromISR();
+    if (is_initiator) {
+        initiator_abort_i(TRANSACTION_NO_RESPONSE);
+    } else {
+        target_abort_i();
+    }
+    osalSysUnlockFromISR();
+}
+
+static void serial_txend_cb(UARTDriver *uartp) {
+    (void)uartp;
+    osalSysLockFromISR();
+    // nothing to receive, the transaction is over once the last bit left
+    if (is_initiator && active_rx_len == 0) {
+        initiator_complete_i(TRANSACTION_END);
+    }
+    osalSysUnlockFromISR();
+}
+
+static void serial_rxend_cb(UARTDriver *uartp) {
+    (void)uartp;
+    osalSysLockFromISR();
+    if (is_initiator) {
+        initiator_complete_i(TRANSACTION_END);
+    } else {
+        target_rx_i();
+    }
+    osalSysUnlockFromISR();
+}
+
+static void serial_rxerr_cb(UARTDriver *uartp, uartflags_t e) {
+    (void)uartp;
+    (void)e;
+    osalSysLockFromISR();
+    if (is_initiator) {
+        initiator_abort_i(TRANSACTION_DATA_ERROR);
+    } else {
+        target_abort_i();
+    }
+    osalSysUnlockFromISR();
+}
+
+static const UARTConfig serial_config = {
+    .txend2_cb = serial_txend_cb,
+    .rxend_cb  = serial_rxend_cb,
+    .rxerr_cb  = serial_rxerr_cb,
+    .speed     = SERIAL_USART_SPEED,
+    .cr3       = SERIAL_USART_CR3,
+};
+
+static void serial_usart_init(SSTD_t *sstd_table, int sstd_table_size) {
+    Transaction_table      = sstd_table;
+    Transaction_table_size = 0;
+
+    // The split transport checks its table against these limits at compile
+    // time. Any other table the DMA buffers cannot hold is refused rather
+    // than overrunning memory, and every transaction then reports an error.
+    bool fits = sstd_table_size <= SERIAL_USART_MAX_TRANSACTIONS;
+    if (!fits) {
+        uprintf("serial_usart: %d transactions, SERIAL_USART_MAX_TRANSACTIONS is %d\n", sstd_table_size, SERIAL_USART_MAX_TRANSACTIONS);
+    }
+    for (int i = 0; fits && i < sstd_table_size; i++) {
+        if (sstd_table[i].initiator2target_buffer_size > SERIAL_USART_BUFFER_SIZE || sstd_table[i].target2initiator_buffer_size > SERIAL_USART_BUFFER_SIZE) {
+            uprintf("serial_usart: transaction %d is larger than SERIAL_USART_BUFFER_SIZE (%d)\n", i, SERIAL_USART_BUFFER_SIZE);
+            fits = false;
+        }
+    }
+    if (fits) {
+        Transaction_table_size = (uint8_t)sstd_table_size;
+    }
+
+    for (uint8_t i = 0; i < SERIAL_USART_MAX_TRANSACTIONS; i++) {
+        slots[i].state       = SLOT_IDLE;
+        slots[i].last_status = TRANSACTION_NO_RESPONSE;
+        slots[i].tx[0]       = i;
+    }
+
+#if defined(USE_GPIOV1)
+#    ifdef SERIAL_USART_FULL_DUPLEX
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_STM32_ALTERNATE_PUSHPULL);
+    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_INPUT_PULLUP);
+#    else
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_STM32_ALTERNATE_OPENDRAIN);
+#    endif
+#else
+#    ifdef SERIAL_USART_FULL_DUPLEX
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_TX_PAL_MODE) | PAL_STM32_OTYPE_PUSHPULL);
+    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_RX_PAL_MODE) | PAL_STM32_PUPDR_PULLUP);
+#    else
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_TX_PAL_MODE) | PAL_STM32_OTYPE_OPENDRAIN | PAL_STM32_PUPDR_PULLUP);
+#    endif
+#endif
+
+    chVTObjectInit(&serial_timeout_vt);
+    uartStart(&SERIAL_USART_DRIVER, &serial_config);
+}
+
+void soft_serial_initiator_init(SSTD_t *sstd_table, int sstd_table_size) {
+    is_initiator = true;
+    serial_usart_init(sstd_table, sstd_table_size);
+}
+
+void soft_serial_target_init(SSTD_t *sstd_table, int sstd_table_size) {
+    is_initiator = false;
+    serial_usart_init(sstd_table, sstd_table_size);
+
+    osalSysLock();
+    target_listen_i();
+    osalSysUnlock();
+}
+
+// Queue the transaction and return how the previous one with the same id
+// went. On success its reply has been copied into target2initiator_buffer.
+#ifndef SERIAL_USE_MULTI_TRANSACTION
+int soft_serial_transaction(void) {
+    int sstd_index = 0;
+#else
+int soft_serial_transaction(int sstd_index) {
+#endif
+    if (sstd_index >= Transaction_table_size) {
+        return TRANSACTION_TYPE_ERROR;
+    }
+    SSTD_t *       trans = &Transaction_table[sstd_index];
+    serial_slot_t *slot  = &slots[sstd_index];
+
+    osalSysLock();
+    if (slot->state == SLOT_DONE) {
+        slot->last_status = slot->done_status;
+        if (slot->last_status == TRANSACTION_END) {
+            memcpy(trans->target2initiator_buffer, &slot->rx[SERIAL_ECHO(1 + trans->initiator2target_buffer_size)], trans->target2initiator_buffer_size);
+        }
+        slot->state = SLOT_IDLE;
+    }
+    // a request that has not started yet still picks up the latest data
+    if (slot->state == SLOT_IDLE || slot->state == SLOT_QUEUED) {
+        memcpy(&slot->tx[1], trans->initiator2target_buffer, trans->initiator2target_buffer_size);
+        slot->state = SLOT_QUEUED;
+        if (active_slot < 0) {
+            initiator_start_next_i();
+        }
+    }
+    osalSysUnlock();
+
+    *trans->status = slot->last_status;
+    return slot->last_status;
+}
+
+#ifdef SERIAL_USE_MULTI_TRANSACTION
+int soft_serial_get_and_clean_status(int sstd_index) {
+    SSTD_t *trans = &Transaction_table[sstd_index];
+    osalSysLock();
+    int retval     = *trans->status;
+    *trans->status = 0;
+    osalSysUnlock();
+    return retval;
+}
+#endif
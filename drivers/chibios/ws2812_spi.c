@@ -23,7 +23,34 @@
 #define RESET_SIZE 200
 #define PREAMBLE_SIZE 4
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+#define TXBUF_SIZE (PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE)
+
+/*
+ * Frames are encoded into the back buffer while the front one is being sent.
+ * A frame that arrives while another is in flight waits in the back buffer
+ * and is sent from the end callback; if a newer one arrives first, the
+ * waiting frame is dropped, so only the latest colors are ever queued.
+ */
+static uint8_t       txbuf[2][TXBUF_SIZE] = {{0}};
+static uint8_t       tx_back              = 0;
+static volatile bool tx_busy              = false;
+static volatile bool tx_pending           = false;
+
+static void ws2812_start_send_back_i(void) {
+    spiStartSendI(&WS2812_SPI, TXBUF_SIZE, txbuf[tx_back]);
+    tx_back ^= 1;
+}
+
+static void ws2812_spi_end_cb(SPIDriver* spip) {
+    chSysLockFromISR();
+    if (tx_pending) {
+        tx_pending = false;
+        ws2812_start_send_back_i();
+    } else {
+        tx_busy = false;
+    }
+    chSysUnlockFromISR();
+}
 
 /*
  * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
@@ -44,7 +71,7 @@ static uint8_t get_protocol_eq(uint8_t data, int pos) {
 }
 
 static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
+    uint8_t* tx_start = &txbuf[tx_back][PREAMBLE_SIZE];
 
     for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.g, j);
     for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.r, j);
@@ -60,7 +87,7 @@ void ws2812_init(void) {
 
     // TODO: more dynamic baudrate
     static const SPIConfig spicfg = {
-        0, NULL, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN),
+        0, ws2812_spi_end_cb, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN),
         SPI_CR1_BR_1 | SPI_CR1_BR_0  // baudrate : fpclk / 8 => 1tick is 0.32us (2.25 MHz)
     };
 
@@ -76,15 +103,30 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
+#ifdef WS2812_SPI_SYNC
     for (uint8_t i = 0; i < leds; i++) {
         set_led_color_rgb(ledarray[i], i);
     }
 
-    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
-    // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
-#ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    spiSend(&WS2812_SPI, TXBUF_SIZE, txbuf[tx_back]);
 #else
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    // Take the back buffer away from the end callback before encoding into it
+    chSysLock();
+    tx_pending = false;
+    chSysUnlock();
+
+    for (uint8_t i = 0; i < leds; i++) {
+        set_led_color_rgb(ledarray[i], i);
+    }
+
+    // Send async - each led takes ~0.03ms, so a frame still in flight is left to finish and this one goes out after it
+    chSysLock();
+    if (tx_busy) {
+        tx_pending = true;
+    } else {
+        tx_busy = true;
+        ws2812_start_send_back_i();
+    }
+    chSysUnlock();
 #endif
 }
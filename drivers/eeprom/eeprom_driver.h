@@ -16,6 +16,8 @@
 
 #pragma once
 
+// Drivers implement the eeprom_* functions themselves, so they must not be routed through the EEPROM cache
+#define EEPROM_CACHE_BACKEND
 #include "eeprom.h"
 
 void eeprom_driver_init(void);
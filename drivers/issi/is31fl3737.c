@@ -66,7 +66,9 @@ uint8_t g_twi_transfer_buffer[20];
 // buffers and the transfers in IS31FL3737_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
 uint8_t g_pwm_buffer[DRIVER_COUNT][192];
-bool    g_pwm_buffer_update_required = false;
+
+// One bit per 16 byte chunk of the buffer that needs sending.
+uint16_t g_pwm_buffer_update_required = 0;
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24] = {{0}};
 bool    g_led_control_registers_update_required   = false;
@@ -84,32 +86,35 @@ void IS31FL3737_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
-void IS31FL3737_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+void IS31FL3737_write_pwm_chunks(uint8_t addr, uint8_t *pwm_buffer, uint16_t chunks) {
     // assumes PG1 is already selected
 
-    // transmit PWM registers in 12 transfers of 16 bytes
-    // g_twi_transfer_buffer[] is 20 bytes
-
-    // iterate over the pwm_buffer contents at 16 byte intervals
-    for (int i = 0; i < 192; i += 16) {
-        g_twi_transfer_buffer[0] = i;
-        // copy the data from i to i+15
-        // device will auto-increment register for data after the first byte
-        // thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer
-        for (int j = 0; j < 16; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
+    // the PWM registers are split into 12 chunks of 16 bytes, bit n of chunks
+    // marks chunk n for sending. Each run of consecutive chunks goes out in a
+    // single transfer, as the device auto-increments the register for data
+    // after the first byte.
+    for (uint8_t first = 0; first < 12; first++) {
+        if (!(chunks & (1 << first))) {
+            continue;
+        }
+        uint8_t last = first;
+        while (last + 1 < 12 && (chunks & (1 << (last + 1)))) {
+            last++;
         }
 
 #if ISSI_PERSISTENCE > 0
         for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
+            if (i2c_writeReg(addr << 1, first * 16, pwm_buffer + first * 16, (last - first + 1) * 16, ISSI_TIMEOUT) == 0) break;
         }
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+        i2c_writeReg(addr << 1, first * 16, pwm_buffer + first * 16, (last - first + 1) * 16, ISSI_TIMEOUT);
 #endif
+        first = last;
     }
 }
 
+void IS31FL3737_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) { IS31FL3737_write_pwm_chunks(addr, pwm_buffer, (1 << 12) - 1); }
+
 void IS31FL3737_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -155,10 +160,14 @@ void IS31FL3737_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
+        // Leave the update flag alone if nothing changes
+        if (g_pwm_buffer[led.driver][led.r] == red && g_pwm_buffer[led.driver][led.g] == green && g_pwm_buffer[led.driver][led.b] == blue) {
+            return;
+        }
         g_pwm_buffer[led.driver][led.r] = red;
         g_pwm_buffer[led.driver][led.g] = green;
         g_pwm_buffer[led.driver][led.b] = blue;
-        g_pwm_buffer_update_required    = true;
+        g_pwm_buffer_update_required |= (1 << (led.r / 16)) | (1 << (led.g / 16)) | (1 << (led.b / 16));
     }
 }
 
@@ -203,10 +212,10 @@ void IS31FL3737_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
         IS31FL3737_write_register(addr1, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
         IS31FL3737_write_register(addr1, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
-        IS31FL3737_write_pwm_buffer(addr1, g_pwm_buffer[0]);
+        IS31FL3737_write_pwm_chunks(addr1, g_pwm_buffer[0], g_pwm_buffer_update_required);
         // IS31FL3737_write_pwm_buffer(addr2, g_pwm_buffer[1]);
     }
-    g_pwm_buffer_update_required = false;
+    g_pwm_buffer_update_required = 0;
 }
 
 void IS31FL3737_update_led_control_registers(uint8_t addr1, uint8_t addr2) {
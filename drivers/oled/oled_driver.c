@@ -217,10 +217,11 @@ void oled_clear(void) {
     oled_dirty  = -1;  // -1 will be max value as long as display_dirty is unsigned type
 }
 
-static void calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
+static void calc_bounds(uint8_t update_start, uint8_t block_count, uint8_t *cmd_array) {
     // Calculate commands to set memory addressing bounds.
-    uint8_t start_page   = OLED_BLOCK_SIZE * update_start / OLED_DISPLAY_WIDTH;
-    uint8_t start_column = OLED_BLOCK_SIZE * update_start % OLED_DISPLAY_WIDTH;
+    uint16_t first        = OLED_BLOCK_SIZE * update_start;
+    uint8_t  start_page   = first / OLED_DISPLAY_WIDTH;
+    uint8_t  start_column = first % OLED_DISPLAY_WIDTH;
 #if (OLED_IC == OLED_IC_SH1106)
     // Commands for Page Addressing Mode. Sets starting page and column; has no end bound.
     // Column value must be split into high and low nybble and sent as two commands.
@@ -232,10 +233,29 @@ static void calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
     cmd_array[5] = NOP;
 #else
     // Commands for use in Horizontal Addressing mode.
-    cmd_array[1] = start_column;
-    cmd_array[4] = start_page;
-    cmd_array[2] = (OLED_BLOCK_SIZE + OLED_DISPLAY_WIDTH - 1) % OLED_DISPLAY_WIDTH + cmd_array[1];
-    cmd_array[5] = (OLED_BLOCK_SIZE + OLED_DISPLAY_WIDTH - 1) / OLED_DISPLAY_WIDTH - 1;
+    uint16_t last = OLED_BLOCK_SIZE * (update_start + block_count) - 1;
+    cmd_array[1]  = start_column;
+    cmd_array[4]  = start_page;
+    cmd_array[2]  = last % OLED_DISPLAY_WIDTH;
+    cmd_array[5]  = last / OLED_DISPLAY_WIDTH;
+#endif
+}
+
+// Whether a run of blocks can be written through a single address window
+static bool block_run_fits(uint8_t update_start, uint8_t block_count) {
+    uint16_t first = OLED_BLOCK_SIZE * update_start;
+    uint16_t last  = OLED_BLOCK_SIZE * (update_start + block_count) - 1;
+
+    // Within a single page
+    if (first / OLED_DISPLAY_WIDTH == last / OLED_DISPLAY_WIDTH) {
+        return true;
+    }
+#if (OLED_IC == OLED_IC_SH1106)
+    // Page Addressing Mode does not wrap to the next page
+    return false;
+#else
+    // Whole pages, so the column wraps back to the start of the window
+    return first % OLED_DISPLAY_WIDTH == 0 && (last + 1) % OLED_DISPLAY_WIDTH == 0;
 #endif
 }
 
@@ -268,55 +288,74 @@ void oled_render(void) {
         return;
     }
 
-    // Find first dirty block
-    uint8_t update_start = 0;
-    while (!(oled_dirty & (1 << update_start))) {
-        ++update_start;
-    }
+    uint16_t budget = OLED_UPDATE_BUDGET;
+    do {
+        // Find first dirty block
+        uint8_t update_start = 0;
+        while (!(oled_dirty & ((OLED_BLOCK_TYPE)1 << update_start))) {
+            ++update_start;
+        }
 
-    // Set column & page position
-    static uint8_t display_start[] = {I2C_CMD, COLUMN_ADDR, 0, OLED_DISPLAY_WIDTH - 1, PAGE_ADDR, 0, OLED_DISPLAY_HEIGHT / 8 - 1};
-    if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
-        calc_bounds(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
-    } else {
-        calc_bounds_90(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
-    }
+        // Merge the dirty blocks that follow it, as far as the budget and a single address window allow
+        uint8_t block_count = 1;
+        if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
+            for (uint8_t count = 2; update_start + count <= OLED_BLOCK_COUNT && OLED_BLOCK_SIZE * count <= budget; ++count) {
+                if (!(oled_dirty & ((OLED_BLOCK_TYPE)1 << (update_start + count - 1)))) {
+                    break;
+                }
+                if (block_run_fits(update_start, count)) {
+                    block_count = count;
+                }
+            }
+        }
 
-    // Send column & page position
-    if (I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
-        print("oled_render offset command failed\n");
-        return;
-    }
+        // Set column & page position
+        static uint8_t display_start[] = {I2C_CMD, COLUMN_ADDR, 0, OLED_DISPLAY_WIDTH - 1, PAGE_ADDR, 0, OLED_DISPLAY_HEIGHT / 8 - 1};
+        if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
+            calc_bounds(update_start, block_count, &display_start[1]);  // Offset from I2C_CMD byte at the start
+        } else {
+            calc_bounds_90(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
+        }
 
-    if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
-        // Send render data chunk as is
-        if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
-            print("oled_render data failed\n");
+        // Send column & page position
+        if (I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
+            print("oled_render offset command failed\n");
             return;
         }
-    } else {
-        // Rotate the render chunks
-        const static uint8_t source_map[] = OLED_SOURCE_MAP;
-        const static uint8_t target_map[] = OLED_TARGET_MAP;
-
-        static uint8_t temp_buffer[OLED_BLOCK_SIZE];
-        memset(temp_buffer, 0, sizeof(temp_buffer));
-        for (uint8_t i = 0; i < sizeof(source_map); ++i) {
-            rotate_90(&oled_buffer[OLED_BLOCK_SIZE * update_start + source_map[i]], &temp_buffer[target_map[i]]);
-        }
 
-        // Send render data chunk after rotating
-        if (I2C_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
-            print("oled_render90 data failed\n");
-            return;
+        if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
+            // Send render data chunks as is
+            if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE * block_count) != I2C_STATUS_SUCCESS) {
+                print("oled_render data failed\n");
+                return;
+            }
+        } else {
+            // Rotate the render chunks
+            const static uint8_t source_map[] = OLED_SOURCE_MAP;
+            const static uint8_t target_map[] = OLED_TARGET_MAP;
+
+            static uint8_t temp_buffer[OLED_BLOCK_SIZE];
+            memset(temp_buffer, 0, sizeof(temp_buffer));
+            for (uint8_t i = 0; i < sizeof(source_map); ++i) {
+                rotate_90(&oled_buffer[OLED_BLOCK_SIZE * update_start + source_map[i]], &temp_buffer[target_map[i]]);
+            }
+
+            // Send render data chunk after rotating
+            if (I2C_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
+                print("oled_render90 data failed\n");
+                return;
+            }
         }
-    }
 
-    // Turn on display if it is off
-    oled_on();
+        // Turn on display if it is off
+        oled_on();
 
-    // Clear dirty flag
-    oled_dirty &= ~(1 << update_start);
+        // Clear dirty flags
+        for (uint8_t i = 0; i < block_count; ++i) {
+            oled_dirty &= ~((OLED_BLOCK_TYPE)1 << (update_start + i));
+        }
+        budget = budget > OLED_BLOCK_SIZE * block_count ? budget - OLED_BLOCK_SIZE * block_count : 0;
+    } while (oled_dirty && budget >= OLED_BLOCK_SIZE);
 }
 
 void oled_set_cursor(uint8_t col, uint8_t line) {
@@ -116,6 +116,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    define OLED_COLUMN_OFFSET 0
 #endif
 
+// Bytes of display data oled_render() may send per call, at least one block is always sent
+#if !defined(OLED_UPDATE_BUDGET)
+#    define OLED_UPDATE_BUDGET OLED_BLOCK_SIZE
+#endif
+
 // Address to use for the i2c oled communication
 #if !defined(OLED_DISPLAY_ADDRESS)
 #    define OLED_DISPLAY_ADDRESS 0x3C
@@ -74,3 +74,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define DEBOUNCE    5
 #define USB_MAX_POWER_CONSUMPTION 500
+
+#ifdef BALLER
+/* matrix.c handles PCINT0 for the trackball */
+#    define MATRIX_IDLE_PCINT0_HANDLED
+#endif
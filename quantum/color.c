@@ -18,36 +18,17 @@
 #include "led_tables.h"
 #include "progmem.h"
 
-RGB hsv_to_rgb(HSV hsv) {
+/* The color of hue h at saturation s and value v, p being the
+ * (v * (255 - s)) >> 8 term that only depends on s and v. Fixed point
+ * throughout, the h * 6 / 255 sector is worked out without a division.
+ */
+static inline RGB hue_to_rgb(uint8_t h, uint8_t s, uint8_t v, uint8_t p) {
     RGB      rgb;
-    uint8_t  region, remainder, p, q, t;
-    uint16_t h, s, v;
-
-    if (hsv.s == 0) {
-#ifdef USE_CIE1931_CURVE
-        rgb.r = rgb.g = rgb.b = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-#else
-        rgb.r = hsv.v;
-        rgb.g = hsv.v;
-        rgb.b = hsv.v;
-#endif
-        return rgb;
-    }
-
-    h = hsv.h;
-    s = hsv.s;
-#ifdef USE_CIE1931_CURVE
-    v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-#else
-    v = hsv.v;
-#endif
-
-    region    = h * 6 / 255;
-    remainder = (h * 2 - region * 85) * 3;
-
-    p = (v * (255 - s)) >> 8;
-    q = (v * (255 - ((s * remainder) >> 8))) >> 8;
-    t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+    uint16_t h6        = h * 6;
+    uint8_t  region    = (h6 + (h6 >> 8) + 1) >> 8;
+    uint8_t  remainder = (h * 2 - region * 85) * 3;
+    uint8_t  q         = (v * (255 - ((s * remainder) >> 8))) >> 8;
+    uint8_t  t         = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
 
     switch (region) {
         case 6:
@@ -86,6 +67,39 @@ RGB hsv_to_rgb(HSV hsv) {
     return rgb;
 }
 
+static inline uint8_t hsv_value(uint8_t v) {
+#ifdef USE_CIE1931_CURVE
+    return pgm_read_byte(&CIE1931_CURVE[v]);
+#else
+    return v;
+#endif
+}
+
+RGB hsv_to_rgb(HSV hsv) {
+    uint8_t v = hsv_value(hsv.v);
+
+    if (hsv.s == 0) {
+        return (RGB){.r = v, .g = v, .b = v};
+    }
+
+    return hue_to_rgb(hsv.h, hsv.s, v, (v * (255 - hsv.s)) >> 8);
+}
+
+void hsv_to_rgb_ramp(HSV hsv, uint8_t hue_step, LED_TYPE *led, uint8_t count) {
+    uint8_t v = hsv_value(hsv.v);
+    uint8_t p = (v * (255 - hsv.s)) >> 8;
+
+    for (uint8_t i = 0; i < count; i++, hsv.h += hue_step) {
+        RGB rgb = hsv.s ? hue_to_rgb(hsv.h, hsv.s, v, p) : (RGB){.r = v, .g = v, .b = v};
+        led[i].r = rgb.r;
+        led[i].g = rgb.g;
+        led[i].b = rgb.b;
+#ifdef RGBW
+        led[i].w = 0;
+#endif
+    }
+}
+
 #ifdef RGBW
 #    ifndef MIN
 #        define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -64,6 +64,11 @@ typedef struct PACKED {
 #endif
 
 RGB hsv_to_rgb(HSV hsv);
+/* Converts count colors that only differ in hue into led, the hue of color i
+ * being hsv.h + i * hue_step. Gives the same colors as hsv_to_rgb(), with the
+ * saturation and value terms worked out once for the whole run.
+ */
+void hsv_to_rgb_ramp(HSV hsv, uint8_t hue_step, LED_TYPE *led, uint8_t count);
 #ifdef RGBW
 void convert_rgb_to_rgbw(LED_TYPE *led);
 #endif
@@ -0,0 +1,127 @@
+/*
+Copyright 2020 QMK
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Symmetric per-key algorithm using vertical counters. Behaves like sym_pk: when a
+key has been different from its debounced state for DEBOUNCE milliseconds, the
+change is pushed, and a key that bounces back restarts its count.
+
+Instead of a counter per key, each row keeps its counters as bit-planes: bit c
+of plane p is bit p of the counter for column c. Resetting, incrementing and
+comparing the counters of a whole row is then a few AND/OR/XOR operations on
+matrix_row_t, whatever the number of columns, and no memory is allocated.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#if DEBOUNCE > 255
+#    undef DEBOUNCE
+#    define DEBOUNCE 255
+#endif
+
+#if DEBOUNCE < 2
+#    define COUNTER_PLANES 1
+#elif DEBOUNCE < 4
+#    define COUNTER_PLANES 2
+#elif DEBOUNCE < 8
+#    define COUNTER_PLANES 3
+#elif DEBOUNCE < 16
+#    define COUNTER_PLANES 4
+#elif DEBOUNCE < 32
+#    define COUNTER_PLANES 5
+#elif DEBOUNCE < 64
+#    define COUNTER_PLANES 6
+#elif DEBOUNCE < 128
+#    define COUNTER_PLANES 7
+#else
+#    define COUNTER_PLANES 8
+#endif
+
+#if DEBOUNCE > 0
+static matrix_row_t counters[MATRIX_ROWS][COUNTER_PLANES];
+// keys that already differed from their debounced state on the previous call
+static matrix_row_t counting[MATRIX_ROWS];
+static bool         any_counting;
+static uint16_t     last_time;
+
+void debounce_init(uint8_t num_rows) { last_time = timer_read(); }
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    uint16_t elapsed = timer_elapsed(last_time);
+    last_time += elapsed;
+    if (elapsed > DEBOUNCE) {
+        elapsed = DEBOUNCE;
+    }
+
+    if (!changed && !any_counting) {
+        return;
+    }
+
+    any_counting = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t *planes = counters[row];
+        matrix_row_t  delta  = raw[row] ^ cooked[row];
+        // only keys that stayed different since the last call keep counting
+        matrix_row_t active = delta & counting[row];
+
+        for (uint8_t p = 0; p < COUNTER_PLANES; p++) {
+            planes[p] &= active;
+        }
+
+        for (uint16_t tick = 0; tick < elapsed && active; tick++) {
+            // ripple-carry increment of every active counter
+            matrix_row_t carry = active;
+            for (uint8_t p = 0; p < COUNTER_PLANES; p++) {
+                matrix_row_t next = planes[p] & carry;
+                planes[p] ^= carry;
+                carry = next;
+            }
+
+            // counters that reached DEBOUNCE push their key
+            matrix_row_t done = active;
+            for (uint8_t p = 0; p < COUNTER_PLANES; p++) {
+                done &= (DEBOUNCE & (1 << p)) ? planes[p] : ~planes[p];
+            }
+            if (done) {
+                cooked[row] ^= done;
+                active &= ~done;
+                for (uint8_t p = 0; p < COUNTER_PLANES; p++) {
+                    planes[p] &= ~done;
+                }
+            }
+        }
+
+        counting[row] = raw[row] ^ cooked[row];
+        if (counting[row]) {
+            any_counting = true;
+        }
+    }
+}
+#else
+void debounce_init(uint8_t num_rows) {}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        cooked[row] = raw[row];
+    }
+}
+#endif
+
+bool debounce_active(void) { return true; }
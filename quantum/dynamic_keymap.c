@@ -20,39 +20,12 @@
 #include "progmem.h"  // to read default from flash
 #include "quantum.h"  // for send_string()
 #include "dynamic_keymap.h"
-#include "via.h"  // for default VIA_EEPROM_ADDR_END
-
-#ifndef DYNAMIC_KEYMAP_LAYER_COUNT
-#    define DYNAMIC_KEYMAP_LAYER_COUNT 4
-#endif
+#include <string.h>
 
 #ifndef DYNAMIC_KEYMAP_MACRO_COUNT
 #    define DYNAMIC_KEYMAP_MACRO_COUNT 16
 #endif
 
-// This is the default EEPROM max address to use for dynamic keymaps.
-// The default is the ATmega32u4 EEPROM max address.
-// Explicitly override it if the keyboard uses a microcontroller with
-// more EEPROM *and* it makes sense to increase it.
-#ifndef DYNAMIC_KEYMAP_EEPROM_MAX_ADDR
-#    define DYNAMIC_KEYMAP_EEPROM_MAX_ADDR 1023
-#endif
-
-// If DYNAMIC_KEYMAP_EEPROM_ADDR not explicitly defined in config.h,
-// default it start after VIA_EEPROM_CUSTOM_ADDR+VIA_EEPROM_CUSTOM_SIZE
-#ifndef DYNAMIC_KEYMAP_EEPROM_ADDR
-#    ifdef VIA_EEPROM_CUSTOM_CONFIG_ADDR
-#        define DYNAMIC_KEYMAP_EEPROM_ADDR (VIA_EEPROM_CUSTOM_CONFIG_ADDR + VIA_EEPROM_CUSTOM_CONFIG_SIZE)
-#    else
-#        error DYNAMIC_KEYMAP_EEPROM_ADDR not defined
-#    endif
-#endif
-
-// Dynamic macro starts after dynamic keymaps
-#ifndef DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR
-#    define DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR (DYNAMIC_KEYMAP_EEPROM_ADDR + (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2))
-#endif
-
 // Sanity check that dynamic keymaps fit in available EEPROM
 // If there's not 100 bytes available for macros, then something is wrong.
 // The keyboard should override DYNAMIC_KEYMAP_LAYER_COUNT to reduce it,
@@ -88,6 +61,7 @@ void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint
     // Big endian, so we can read/write EEPROM directly from host if we want
     eeprom_update_byte(address, (uint8_t)(keycode >> 8));
     eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+    layer_lookup_cache_clear();
 }
 
 void dynamic_keymap_reset(void) {
@@ -103,32 +77,26 @@ void dynamic_keymap_reset(void) {
     }
 }
 
+// Number of bytes of a size byte transfer at offset that lie within a buffer of buffer_size bytes
+static uint16_t dynamic_keymap_clamp_size(uint16_t offset, uint16_t size, uint16_t buffer_size) {
+    if (offset >= buffer_size) {
+        return 0;
+    }
+    return size < buffer_size - offset ? size : buffer_size - offset;
+}
+
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *target                     = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
-        }
-        source++;
-        target++;
-    }
+    uint16_t valid_size                 = dynamic_keymap_clamp_size(offset, size, dynamic_keymap_eeprom_size);
+    eeprom_read_block(data, ((void *)DYNAMIC_KEYMAP_EEPROM_ADDR) + offset, valid_size);
+    memset(data + valid_size, 0x00, size - valid_size);
 }
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *source                     = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
-    }
+    uint16_t valid_size                 = dynamic_keymap_clamp_size(offset, size, dynamic_keymap_eeprom_size);
+    eeprom_update_block(data, ((void *)DYNAMIC_KEYMAP_EEPROM_ADDR) + offset, valid_size);
+    layer_lookup_cache_clear();
 }
 
 // This overrides the one in quantum/keymap_common.c
@@ -145,29 +113,14 @@ uint8_t dynamic_keymap_macro_get_count(void) { return DYNAMIC_KEYMAP_MACRO_COUNT
 uint16_t dynamic_keymap_macro_get_buffer_size(void) { return DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; }
 
 void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   source = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *target = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
-        }
-        source++;
-        target++;
-    }
+    uint16_t valid_size = dynamic_keymap_clamp_size(offset, size, DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    eeprom_read_block(data, ((void *)DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR) + offset, valid_size);
+    memset(data + valid_size, 0x00, size - valid_size);
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *source = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
-    }
+    uint16_t valid_size = dynamic_keymap_clamp_size(offset, size, DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    eeprom_update_block(data, ((void *)DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR) + offset, valid_size);
 }
 
 void dynamic_keymap_macro_reset(void) {
@@ -179,6 +132,23 @@ void dynamic_keymap_macro_reset(void) {
     }
 }
 
+#ifdef SEND_STRING_ASYNC_ENABLE
+// Number of send_string_async() operations the macro at p takes
+static uint16_t dynamic_keymap_macro_op_count(void *p) {
+    uint16_t count = 0;
+    uint8_t  data;
+    while ((data = eeprom_read_byte(p++)) != 0) {
+        if (data == SS_TAP_CODE || data == SS_DOWN_CODE || data == SS_UP_CODE) {
+            if (eeprom_read_byte(p++) == 0) {
+                break;
+            }
+        }
+        count++;
+    }
+    return count;
+}
+#endif
+
 void dynamic_keymap_macro_send(uint8_t id) {
     if (id >= DYNAMIC_KEYMAP_MACRO_COUNT) {
         return;
@@ -210,6 +180,11 @@ void dynamic_keymap_macro_send(uint8_t id) {
         ++p;
     }
 
+#ifdef SEND_STRING_ASYNC_ENABLE
+    // Queue the macro when it fits, so that a long macro doesn't stall the matrix scan
+    bool async = dynamic_keymap_macro_op_count(p) <= send_string_async_free();
+#endif
+
     // Send the macro string one or three chars at a time
     // by making temporary 1 or 3 char strings
     char data[4] = {0, 0, 0, 0};
@@ -232,6 +207,12 @@ void dynamic_keymap_macro_send(uint8_t id) {
                 break;
             }
         }
+#ifdef SEND_STRING_ASYNC_ENABLE
+        if (async) {
+            send_string_async(data);
+            continue;
+        }
+#endif
         send_string(data);
     }
 }
@@ -49,6 +49,12 @@ uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
 // translates function id to action
 uint16_t keymap_function_id_to_action(uint16_t function_id);
 
+// translates keycode to action, without the action lookup table
+action_t action_for_keycode(uint16_t keycode);
+
+// forgets the actions looked up with ACTION_LOOKUP_TABLE_LAYERS
+void action_lookup_table_clear(void);
+
 extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
 extern const uint16_t fn_actions[];
 
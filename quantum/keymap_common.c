@@ -40,11 +40,60 @@ extern keymap_config_t keymap_config;
 
 #include <inttypes.h>
 
+#if defined(ACTION_LOOKUP_TABLE_LAYERS) && !defined(DYNAMIC_KEYMAP_ENABLE)
+#    define USE_ACTION_LOOKUP_TABLE
+#endif
+
+#ifdef USE_ACTION_LOOKUP_TABLE
+static action_t action_lookup_table[ACTION_LOOKUP_TABLE_LAYERS][MATRIX_ROWS][MATRIX_COLS];
+static bool     action_lookup_table_valid;
+static uint16_t action_lookup_table_config;
+
+/** \brief Converts every key of the first ACTION_LOOKUP_TABLE_LAYERS layers
+ *
+ * The actions depend on keymap_config (swapped modifiers and such), so
+ * action_for_key() rebuilds the table whenever keymap_config has changed.
+ */
+static void action_lookup_table_build(void) {
+    for (uint8_t layer = 0; layer < ACTION_LOOKUP_TABLE_LAYERS; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                keypos_t key                         = {.col = col, .row = row};
+                action_lookup_table[layer][row][col] = action_for_keycode(keymap_key_to_keycode(layer, key));
+            }
+        }
+    }
+    action_lookup_table_config = keymap_config.raw;
+    action_lookup_table_valid  = true;
+}
+#endif
+
+/** \brief Rebuild the action lookup table on its next use
+ *
+ * Only needed by code that changes what keymap_key_to_keycode() returns.
+ */
+void action_lookup_table_clear(void) {
+#ifdef USE_ACTION_LOOKUP_TABLE
+    action_lookup_table_valid = false;
+#endif
+}
+
 /* converts key to action */
 action_t action_for_key(uint8_t layer, keypos_t key) {
+#ifdef USE_ACTION_LOOKUP_TABLE
+    if (layer < ACTION_LOOKUP_TABLE_LAYERS) {
+        if (!action_lookup_table_valid || action_lookup_table_config != keymap_config.raw) {
+            action_lookup_table_build();
+        }
+        return action_lookup_table[layer][key.row][key.col];
+    }
+#endif
     // 16bit keycodes - important
-    uint16_t keycode = keymap_key_to_keycode(layer, key);
+    return action_for_keycode(keymap_key_to_keycode(layer, key));
+}
 
+/* converts keycode to action */
+action_t action_for_keycode(uint16_t keycode) {
     // keycode remapping
     keycode = keycode_config(keycode);
 
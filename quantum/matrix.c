@@ -19,7 +19,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "matrix.h"
 #include "debounce.h"
+#include "scan_profile.h"
 #include "quantum.h"
+#include "matrix_port_scan.h"
+#include "suspend.h"
 
 #ifdef DIRECT_PINS
 static pin_t direct_pins[MATRIX_ROWS][MATRIX_COLS] = DIRECT_PINS;
@@ -82,6 +85,9 @@ static void init_pins(void) {
     for (uint8_t x = 0; x < MATRIX_COLS; x++) {
         setPinInputHigh(col_pins[x]);
     }
+#        ifdef MATRIX_PORT_SCAN
+    matrix_port_scan_init(col_pins);
+#        endif
 }
 
 static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
@@ -95,6 +101,9 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     select_row(current_row);
     matrix_io_delay();
 
+#        ifdef MATRIX_PORT_SCAN
+    current_matrix[current_row] = matrix_port_scan_read_cols();
+#        else
     // For each col...
     for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
         // Select the col pin to read (active low)
@@ -103,6 +112,7 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
         // Populate the matrix row with the state of the col pin
         current_matrix[current_row] |= pin_state ? 0 : (MATRIX_ROW_SHIFTER << col_index);
     }
+#        endif
 
     // Unselect row
     unselect_row(current_row);
@@ -202,8 +212,84 @@ uint8_t matrix_scan(void) {
     }
 #endif
 
+    scan_profile_begin(SCAN_PROFILE_DEBOUNCE);
     debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
+    scan_profile_end(SCAN_PROFILE_DEBOUNCE);
 
     matrix_scan_quantum();
     return (uint8_t)changed;
 }
+
+#ifdef MATRIX_IDLE_TIMEOUT
+// Lets the platform wake from idle as soon as a sense line goes low
+static void matrix_wake_pin(pin_t pin) {
+#    ifdef PROTOCOL_CHIBIOS
+    suspend_idle_wake_line(pin);
+#    endif
+}
+
+void matrix_wake_arm(void) {
+#    if defined(DIRECT_PINS)
+    // every switch already pulls its own pin low, only arm the pins
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (direct_pins[row][col] != NO_PIN) {
+                matrix_wake_pin(direct_pins[row][col]);
+            }
+        }
+    }
+#    elif (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        select_row(x);
+    }
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        matrix_wake_pin(col_pins[x]);
+    }
+#    elif (DIODE_DIRECTION == ROW2COL)
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        select_col(x);
+    }
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        matrix_wake_pin(row_pins[x]);
+    }
+#    endif
+}
+
+bool matrix_wake_check(void) {
+#    if defined(DIRECT_PINS)
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            pin_t pin = direct_pins[row][col];
+            if (pin != NO_PIN && !readPin(pin)) {
+                return true;
+            }
+        }
+    }
+#    elif (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        if (!readPin(col_pins[x])) {
+            return true;
+        }
+    }
+#    elif (DIODE_DIRECTION == ROW2COL)
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        if (!readPin(row_pins[x])) {
+            return true;
+        }
+    }
+#    endif
+    return false;
+}
+
+void matrix_wake_disarm(void) {
+#    ifdef PROTOCOL_CHIBIOS
+    suspend_idle_wake_clear();
+#    endif
+#    if defined(DIRECT_PINS)
+#    elif (DIODE_DIRECTION == COL2ROW)
+    unselect_rows();
+#    elif (DIODE_DIRECTION == ROW2COL)
+    unselect_cols();
+#    endif
+}
+#endif
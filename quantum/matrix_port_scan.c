@@ -0,0 +1,76 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "matrix_port_scan.h"
+
+#ifdef MATRIX_PORT_SCAN
+// Consecutive columns wired to consecutive bits of the same port form a run,
+// which is extracted from a single port read with one shift and mask.
+typedef struct {
+    uint8_t     port;  // index into col_ports
+    uint8_t     bit;   // port bit of the first column in the run
+    uint8_t     col;   // first column in the run
+    port_data_t mask;  // one bit per column in the run
+} col_run_t;
+
+static pin_t     col_ports[MATRIX_COLS];  // one column pin on each port that is used
+static uint8_t   col_port_count;
+static col_run_t col_runs[MATRIX_COLS];
+static uint8_t   col_run_count;
+
+void matrix_port_scan_init(const pin_t col_pins[MATRIX_COLS]) {
+    col_port_count = 0;
+    col_run_count  = 0;
+
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        pin_t   pin  = col_pins[col];
+        uint8_t port = 0;
+
+        while (port < col_port_count && getPinPort(col_ports[port]) != getPinPort(pin)) {
+            port++;
+        }
+        if (port == col_port_count) {
+            col_ports[col_port_count++] = pin;
+        }
+
+        if (col_run_count > 0) {
+            col_run_t *run = &col_runs[col_run_count - 1];
+            if (run->port == port && run->bit + (col - run->col) == getPinBit(pin)) {
+                run->mask = (run->mask << 1) | 1;
+                continue;
+            }
+        }
+        col_runs[col_run_count++] = (col_run_t){.port = port, .bit = getPinBit(pin), .col = col, .mask = 1};
+    }
+}
+
+matrix_row_t matrix_port_scan_read_cols(void) {
+    port_data_t  port_state[MATRIX_COLS];
+    matrix_row_t row = 0;
+
+    // Read each port once (active low)
+    for (uint8_t i = 0; i < col_port_count; i++) {
+        port_state[i] = ~readPort(col_ports[i]);
+    }
+
+    for (uint8_t i = 0; i < col_run_count; i++) {
+        const col_run_t *run = &col_runs[i];
+        row |= (matrix_row_t)((port_state[run->port] >> run->bit) & run->mask) << run->col;
+    }
+
+    return row;
+}
+#endif
@@ -19,6 +19,7 @@
 
 #ifndef COMBO_VARIABLE_LEN
 __attribute__((weak)) combo_t key_combos[COMBO_COUNT] = {};
+#    define COMBO_LEN COMBO_COUNT
 #else
 extern combo_t  key_combos[];
 extern int      COMBO_LEN;
@@ -26,106 +27,264 @@ extern int      COMBO_LEN;
 
 __attribute__((weak)) void process_combo_event(uint8_t combo_index, bool pressed) {}
 
-static uint16_t timer               = 0;
-static uint8_t  current_combo_index = 0;
-static bool     drop_buffer         = false;
-static bool     is_active           = false;
-static bool     b_combo_enable      = true;  // defaults to enabled
+#ifdef COMBO_TERM_PER_COMBO
+__attribute__((weak)) uint16_t get_combo_term(uint16_t combo_index, combo_t *combo) { return COMBO_TERM; }
+#    define COMBO_TERM_FOR(index) get_combo_term(index, &key_combos[index])
+#else
+#    define COMBO_TERM_FOR(index) COMBO_TERM
+#endif
+
+#define COMBO_NONE 0xFFFF
+#define COMBO_STATE_BITS (sizeof(combo_state_t) * 8)
+
+static uint16_t timer          = 0;
+static uint16_t term           = COMBO_TERM;
+static uint16_t pending_combo  = COMBO_NONE;
+static uint16_t combos_held    = 0;
+static bool     is_active      = true;
+static bool     b_combo_enable = true;  // defaults to enabled
 
-static uint8_t buffer_size = 0;
+typedef struct {
+    uint16_t keycode;
 #ifdef COMBO_ALLOW_ACTION_KEYS
-static keyrecord_t key_buffer[MAX_COMBO_LENGTH];
+    keyrecord_t record;
+#endif
+} buffered_key_t;
+
+static uint8_t        buffer_size = 0;
+static buffered_key_t key_buffer[MAX_COMBO_LENGTH];
+
+#if !defined(COMBO_VARIABLE_LEN) && COMBO_COUNT > 0
+#    define COMBO_INDEXED
+/* Combos are indexed by a hash of their keycodes: bucket b has bit i set
+ * if combo i has a key hashing to b. A key event then only looks at the
+ * combos in its bucket instead of reading every combo's key list. The
+ * combos are keymap data, so the index is built on the first key event.
+ */
+#    define COMBO_BUCKET(keycode) (((keycode) ^ ((keycode) >> 8)) % COMBO_INDEX_BUCKETS)
+
+static uint8_t combo_index[COMBO_INDEX_BUCKETS][(COMBO_COUNT + 7) / 8];
+static bool    combo_index_ready = false;
+
+static void build_combo_index(void) {
+    for (uint16_t i = 0; i < COMBO_COUNT; i++) {
+        const uint16_t *keys = key_combos[i].keys;
+        for (uint16_t key; keys && (key = pgm_read_word(keys)) != COMBO_END; keys++) {
+            combo_index[COMBO_BUCKET(key)][i / 8] |= 1 << (i % 8);
+        }
+    }
+    combo_index_ready = true;
+}
+#endif
+
+/* The first combo at or after index that may contain keycode, or COMBO_LEN */
+static uint16_t next_combo(uint16_t keycode, uint16_t index) {
+#ifdef COMBO_INDEXED
+    const uint8_t *bits = combo_index[COMBO_BUCKET(keycode)];
+    for (; index < COMBO_LEN; index++) {
+        uint8_t byte = bits[index / 8] >> (index % 8);
+        if (byte & 1) {
+            return index;
+        }
+        if (!byte) {
+            index |= 7;
+        }
+    }
+    return COMBO_LEN;
 #else
-static uint16_t key_buffer[MAX_COMBO_LENGTH];
+    return index;
 #endif
+}
+
+#define FOR_EACH_COMBO_WITH(keycode, index) for (uint16_t index = next_combo(keycode, 0); index < COMBO_LEN; index = next_combo(keycode, index + 1))
+
+/* Position of keycode in the combo, or -1. Sets count to the combo length. */
+static int8_t combo_key_index(const combo_t *combo, uint16_t keycode, uint8_t *count) {
+    int8_t index = -1;
+    *count       = 0;
+    for (const uint16_t *keys = combo->keys;; ++*count) {
+        uint16_t key = pgm_read_word(&keys[*count]);
+        if (COMBO_END == key) break;
+        if (keycode == key) index = *count;
+    }
+    return index;
+}
+
+static uint8_t combo_length(const combo_t *combo) {
+    uint8_t count = 0;
+    while (pgm_read_word(&combo->keys[count]) != COMBO_END) count++;
+    return count;
+}
+
+static inline bool all_combo_keys_down(const combo_t *combo, uint8_t count) { return combo->state == (combo_state_t)((combo_state_t)~(combo_state_t)0 >> (COMBO_STATE_BITS - count)); }
+
+static bool combo_contains(const combo_t *outer, const combo_t *inner) {
+    uint8_t count;
+    for (const uint16_t *keys = inner->keys; pgm_read_word(keys) != COMBO_END; keys++) {
+        if (combo_key_index(outer, pgm_read_word(keys), &count) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
 
-static inline void send_combo(uint16_t action, bool pressed) {
-    if (action) {
+/* Whether a longer combo, made of the given one plus the key just pressed
+ * and others, could still be completed. */
+static bool longer_combo_possible(uint16_t index, uint8_t count, uint16_t keycode) {
+    FOR_EACH_COMBO_WITH(keycode, other) {
+        uint8_t other_count;
+        if (other == index || key_combos[other].active || combo_key_index(&key_combos[other], keycode, &other_count) < 0) continue;
+        if (other_count > count && !all_combo_keys_down(&key_combos[other], other_count) && combo_contains(&key_combos[other], &key_combos[index])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void send_combo(uint16_t index, bool pressed) {
+    combo_t *combo = &key_combos[index];
+
+    combo->active = pressed;
+    if (combo->keycode) {
         if (pressed) {
-            register_code16(action);
+            register_code16(combo->keycode);
         } else {
-            unregister_code16(action);
+            unregister_code16(combo->keycode);
         }
     } else {
-        process_combo_event(current_combo_index, pressed);
+        process_combo_event(index, pressed);
     }
 }
 
-static inline void dump_key_buffer(bool emit) {
-    if (buffer_size == 0) {
-        return;
-    }
-
-    if (emit) {
-        for (uint8_t i = 0; i < buffer_size; i++) {
+static void emit_key(buffered_key_t *key) {
 #ifdef COMBO_ALLOW_ACTION_KEYS
-            const action_t action = store_or_get_action(key_buffer[i].event.pressed, key_buffer[i].event.key);
-            process_action(&(key_buffer[i]), action);
+    const action_t action = store_or_get_action(key->record.event.pressed, key->record.event.key);
+    process_action(&key->record, action);
 #else
-            register_code16(key_buffer[i]);
-            send_keyboard_report();
+    register_code16(key->keycode);
+    send_keyboard_report();
 #endif
+}
+
+static inline void dump_key_buffer(bool emit) {
+    if (emit) {
+        for (uint8_t i = 0; i < buffer_size; i++) {
+            emit_key(&key_buffer[i]);
         }
     }
+    buffer_size = 0;
+}
 
+/* Sends the combo that was waiting for a longer one, and the buffered keys
+ * that are not part of it. */
+static void fire_pending_combo(void) {
+    combo_t *combo = &key_combos[pending_combo];
+    uint8_t  count;
+
+    send_combo(pending_combo, true);
+    pending_combo = COMBO_NONE;
+    for (uint8_t i = 0; i < buffer_size; i++) {
+        if (combo_key_index(combo, key_buffer[i].keycode, &count) < 0) {
+            emit_key(&key_buffer[i]);
+        }
+    }
     buffer_size = 0;
+    timer       = timer_read();
 }
 
-#define ALL_COMBO_KEYS_ARE_DOWN (((1 << count) - 1) == combo->state)
-#define KEY_STATE_DOWN(key)         \
-    do {                            \
-        combo->state |= (1 << key); \
-    } while (0)
-#define KEY_STATE_UP(key)            \
-    do {                             \
-        combo->state &= ~(1 << key); \
-    } while (0)
+static bool process_combo_press(uint16_t keycode, keyrecord_t *record) {
+    bool     is_combo_key = false;
+    uint16_t best         = COMBO_NONE;
+    uint8_t  best_count   = 0;
+    uint16_t key_term     = 0;
+
+    FOR_EACH_COMBO_WITH(keycode, index) {
+        combo_t *combo = &key_combos[index];
+        uint8_t  count;
+        int8_t   key = combo_key_index(combo, keycode, &count);
+        if (key < 0) continue;
+
+        is_combo_key = true;
+        if (!combo->state) combos_held++;
+        combo->state |= (combo_state_t)1 << key;
+
+        if (COMBO_TERM_FOR(index) > key_term) key_term = COMBO_TERM_FOR(index);
+        /* The longest combo completed by this key wins */
+        if (is_active && !combo->active && count > best_count && all_combo_keys_down(combo, count)) {
+            best       = index;
+            best_count = count;
+        }
+    }
 
-static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) {
-    uint8_t count = 0;
-    uint8_t index = -1;
-    /* Find index of keycode and number of combo keys */
-    for (const uint16_t *keys = combo->keys;; ++count) {
-        uint16_t key = pgm_read_word(&keys[count]);
-        if (keycode == key) index = count;
-        if (COMBO_END == key) break;
+    if (!is_combo_key || !is_active) {
+        /* if no combos claim the key we need to emit the keybuffer */
+        if (pending_combo != COMBO_NONE) fire_pending_combo();
+        dump_key_buffer(true);
+        return true;
     }
 
-    /* Continue processing if not a combo key */
-    if (-1 == (int8_t)index) return false;
+    if (pending_combo != COMBO_NONE) {
+        if (best != COMBO_NONE ? !combo_contains(&key_combos[best], &key_combos[pending_combo]) : !longer_combo_possible(pending_combo, combo_length(&key_combos[pending_combo]), keycode)) {
+            fire_pending_combo();
+        } else if (best != COMBO_NONE) {
+            pending_combo = COMBO_NONE;
+        }
+    }
 
-    bool is_combo_active = is_active;
+    if (best != COMBO_NONE && !longer_combo_possible(best, best_count, keycode)) {
+        send_combo(best, true);
+        /* buffer is only dropped when we complete a combo, so we refresh the timer
+         * here */
+        timer = timer_read();
+        dump_key_buffer(false);
+        return false;
+    }
+
+    /* otherwise the key is consumed and placed in the buffer, possibly
+     * completing a combo that waits for a longer one */
+    if (best != COMBO_NONE) pending_combo = best;
+    if (buffer_size == 0 || key_term > term) term = key_term;
+    timer = timer_read();
+    if (buffer_size < MAX_COMBO_LENGTH) {
+        key_buffer[buffer_size].keycode = keycode;
+#ifdef COMBO_ALLOW_ACTION_KEYS
+        key_buffer[buffer_size].record = *record;
+#endif
+        buffer_size++;
+    }
+    return false;
+}
+
+static bool process_combo_release(uint16_t keycode) {
+    bool is_combo_key = false;
+
+    /* releasing a key settles a combo that waits for a longer one */
+    if (pending_combo != COMBO_NONE) fire_pending_combo();
 
-    if (record->event.pressed) {
-        KEY_STATE_DOWN(index);
+    FOR_EACH_COMBO_WITH(keycode, index) {
+        combo_t *combo = &key_combos[index];
+        uint8_t  count;
+        int8_t   key = combo_key_index(combo, keycode, &count);
+        if (key < 0) continue;
 
-        if (is_combo_active) {
-            if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was pressed */
-                send_combo(combo->keycode, true);
-                drop_buffer = true;
-            }
+        if (combo->active) { /* Combo was released */
+            send_combo(index, false);
+            is_combo_key = true;
         }
-    } else {
-        if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was released */
-            send_combo(combo->keycode, false);
-        } else {
-            /* continue processing without immediately returning */
-            is_combo_active = false;
+        if (combo->state) {
+            combo->state &= ~((combo_state_t)1 << key);
+            if (!combo->state) combos_held--;
         }
-
-        KEY_STATE_UP(index);
     }
 
-    return is_combo_active;
+    if (!is_combo_key) {
+        /* continue processing without immediately returning */
+        dump_key_buffer(true);
+    }
+    return !is_combo_key;
 }
 
-#define NO_COMBO_KEYS_ARE_DOWN (0 == combo->state)
-
 bool process_combo(uint16_t keycode, keyrecord_t *record) {
-    bool is_combo_key          = false;
-    drop_buffer                = false;
-    bool no_combo_keys_pressed = true;
-
     if (keycode == CMB_ON && record->event.pressed) {
         combo_enable();
         return true;
@@ -144,48 +303,28 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     if (!is_combo_enabled()) {
         return true;
     }
-#ifndef COMBO_VARIABLE_LEN
-    for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
-#else
-    for (current_combo_index = 0; current_combo_index < COMBO_LEN; ++current_combo_index) {
-#endif
-        combo_t *combo = &key_combos[current_combo_index];
-        is_combo_key |= process_single_combo(combo, keycode, record);
-        no_combo_keys_pressed = no_combo_keys_pressed && NO_COMBO_KEYS_ARE_DOWN;
+#ifdef COMBO_INDEXED
+    if (!combo_index_ready) {
+        build_combo_index();
     }
+#endif
 
-    if (drop_buffer) {
-        /* buffer is only dropped when we complete a combo, so we refresh the timer
-         * here */
-        timer = timer_read();
-        dump_key_buffer(false);
-    } else if (!is_combo_key) {
-        /* if no combos claim the key we need to emit the keybuffer */
-        dump_key_buffer(true);
-
-        // reset state if there are no combo keys pressed at all
-        if (no_combo_keys_pressed) {
-            timer     = 0;
-            is_active = true;
-        }
-    } else if (record->event.pressed && is_active) {
-        /* otherwise the key is consumed and placed in the buffer */
-        timer = timer_read();
+    bool result = record->event.pressed ? process_combo_press(keycode, record) : process_combo_release(keycode);
 
-        if (buffer_size < MAX_COMBO_LENGTH) {
-#ifdef COMBO_ALLOW_ACTION_KEYS
-            key_buffer[buffer_size++] = *record;
-#else
-            key_buffer[buffer_size++] = keycode;
-#endif
-        }
+    // reset state if there are no combo keys pressed at all
+    if (!combos_held) {
+        timer     = 0;
+        is_active = true;
     }
-
-    return !is_combo_key;
+    return result;
 }
 
 void matrix_scan_combo(void) {
-    if (b_combo_enable && is_active && timer && timer_elapsed(timer) > COMBO_TERM) {
+    if (b_combo_enable && is_active && timer && timer_elapsed(timer) > term) {
+        if (pending_combo != COMBO_NONE) {
+            fire_pending_combo();
+            return;
+        }
         /* This disables the combo, meaning key events for this
          * combo will be handled by the next processors in the chain
          */
@@ -199,6 +338,7 @@ void combo_enable(void) { b_combo_enable = true; }
 void combo_disable(void) {
     b_combo_enable = is_active = false;
     timer                      = 0;
+    pending_combo              = COMBO_NONE;
     dump_key_buffer(true);
 }
 
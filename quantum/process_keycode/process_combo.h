@@ -29,16 +29,19 @@
 #    define MAX_COMBO_LENGTH 8
 #endif
 
-typedef struct {
-    const uint16_t *keys;
-    uint16_t        keycode;
 #ifdef EXTRA_EXTRA_LONG_COMBOS
-    uint32_t state;
+typedef uint32_t combo_state_t;
 #elif EXTRA_LONG_COMBOS
-    uint16_t state;
+typedef uint16_t combo_state_t;
 #else
-    uint8_t state;
+typedef uint8_t combo_state_t;
 #endif
+
+typedef struct {
+    const uint16_t *keys;
+    uint16_t        keycode;
+    combo_state_t   state;
+    bool            active;
 } combo_t;
 
 #define COMBO(ck, ca) \
@@ -53,10 +56,16 @@ typedef struct {
 #ifndef COMBO_TERM
 #    define COMBO_TERM TAPPING_TERM
 #endif
+#ifndef COMBO_INDEX_BUCKETS
+#    define COMBO_INDEX_BUCKETS 16
+#endif
 
 bool process_combo(uint16_t keycode, keyrecord_t *record);
 void matrix_scan_combo(void);
 void process_combo_event(uint8_t combo_index, bool pressed);
+#ifdef COMBO_TERM_PER_COMBO
+uint16_t get_combo_term(uint16_t combo_index, combo_t *combo);
+#endif
 
 void combo_enable(void);
 void combo_disable(void);
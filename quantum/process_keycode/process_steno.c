@@ -63,6 +63,10 @@ static uint8_t      chord[MAX_STATE_SIZE] = {0};
 static int8_t       pressed               = 0;
 static steno_mode_t mode;
 
+// A chord is collected here and sent to the host in a single write
+static uint8_t packet[MAX_STATE_SIZE + 1];
+static uint8_t packet_len;
+
 static const uint8_t boltmap[64] PROGMEM = {TXB_NUL, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_S_L, TXB_S_L, TXB_T_L, TXB_K_L, TXB_P_L, TXB_W_L, TXB_H_L, TXB_R_L, TXB_A_L, TXB_O_L, TXB_STR, TXB_STR, TXB_NUL, TXB_NUL, TXB_NUL, TXB_STR, TXB_STR, TXB_E_R, TXB_U_R, TXB_F_R, TXB_R_R, TXB_P_R, TXB_B_R, TXB_L_R, TXB_G_R, TXB_T_R, TXB_S_R, TXB_D_R, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_NUM, TXB_Z_R};
 
 static void steno_clear_state(void) {
@@ -73,13 +77,18 @@ static void steno_clear_state(void) {
 static void send_steno_state(uint8_t size, bool send_empty) {
     for (uint8_t i = 0; i < size; ++i) {
         if (chord[i] || send_empty) {
-#ifdef VIRTSER_ENABLE
-            virtser_send(chord[i]);
-#endif
+            packet[packet_len++] = chord[i];
         }
     }
 }
 
+static void send_steno_packet(void) {
+#ifdef VIRTSER_ENABLE
+    virtser_send_buffer(packet, packet_len);
+#endif
+    packet_len = 0;
+}
+
 void steno_init() {
     if (!eeconfig_is_enabled()) {
         eeconfig_init();
@@ -107,13 +116,13 @@ static void send_steno_chord(void) {
         switch (mode) {
             case STENO_MODE_BOLT:
                 send_steno_state(BOLT_STATE_SIZE, false);
-#ifdef VIRTSER_ENABLE
-                virtser_send(0);  // terminating byte
-#endif
+                packet[packet_len++] = 0;  // terminating byte
+                send_steno_packet();
                 break;
             case STENO_MODE_GEMINI:
                 chord[0] |= 0x80;  // Indicate start of packet
                 send_steno_state(GEMINI_STATE_SIZE, true);
+                send_steno_packet();
                 break;
         }
     }
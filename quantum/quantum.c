@@ -46,6 +46,10 @@ extern backlight_config_t backlight_config;
 #    include "haptic.h"
 #endif
 
+#ifdef EEPROM_CACHE_ENABLE
+#    include "eeprom.h"
+#endif
+
 #ifdef ENCODER_ENABLE
 #    include "encoder.h"
 #endif
@@ -144,6 +148,9 @@ void reset_keyboard(void) {
 #endif
 #ifdef HAPTIC_ENABLE
     haptic_shutdown();
+#endif
+#ifdef EEPROM_CACHE_ENABLE
+    eeprom_cache_flush();
 #endif
     bootloader_jump();
 }
@@ -181,6 +188,17 @@ void post_process_record_quantum(keyrecord_t *record) {
     post_process_record_kb(keycode, record);
 }
 
+/* Handlers that only act on their own keycodes are gated on that range here, so an ordinary
+ * key skips the call entirely. Handlers that must see every event (key lock, dynamic macros,
+ * tap dance, combos, leader, music, auto shift, ...) are called unconditionally. */
+#define PROCESS_KEYCODE_RANGE(first, last, handler) ((keycode < (first) || keycode > (last)) || handler(keycode, record))
+
+#if defined(UNICODE_ENABLE)
+#    define UNICODE_KEYCODES_MIN QK_UNICODE
+#elif defined(UNICODEMAP_ENABLE)
+#    define UNICODE_KEYCODES_MIN QK_UNICODEMAP
+#endif
+
 /* Core keycode function, hands off handling to other functions,
     then processes internal quantum keycodes, and then processes
     ACTIONs.                                                      */
@@ -230,20 +248,20 @@ bool process_record_quantum(keyrecord_t *record) {
             process_rgb_matrix(keycode, record) &&
 #endif
 #if defined(VIA_ENABLE)
-            process_record_via(keycode, record) &&
+            PROCESS_KEYCODE_RANGE(FN_MO13, MACRO15, process_record_via) &&
 #endif
             process_record_kb(keycode, record) &&
 #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
-            process_midi(keycode, record) &&
+            PROCESS_KEYCODE_RANGE(MIDI_TONE_MIN, MI_BENDU, process_midi) &&
 #endif
 #ifdef AUDIO_ENABLE
-            process_audio(keycode, record) &&
+            PROCESS_KEYCODE_RANGE(AU_ON, MUV_DE, process_audio) &&
 #endif
 #ifdef BACKLIGHT_ENABLE
-            process_backlight(keycode, record) &&
+            PROCESS_KEYCODE_RANGE(BL_ON, BL_BRTG, process_backlight) &&
 #endif
 #ifdef STENO_ENABLE
-            process_steno(keycode, record) &&
+            PROCESS_KEYCODE_RANGE(QK_STENO, QK_STENO_MAX, process_steno) &&
 #endif
 #if (defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
             process_music(keycode, record) &&
@@ -251,8 +269,11 @@ bool process_record_quantum(keyrecord_t *record) {
 #ifdef TAP_DANCE_ENABLE
             process_tap_dance(keycode, record) &&
 #endif
-#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+#if defined(UCIS_ENABLE)
+            // UCIS captures every key while an input is in progress
             process_unicode_common(keycode, record) &&
+#elif defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE)
+            ((keycode < UNICODE_KEYCODES_MIN && (keycode < UNICODE_MODE_FORWARD || keycode > UNICODE_MODE_WINC)) || process_unicode_common(keycode, record)) &&
 #endif
 #ifdef LEADER_ENABLE
             process_leader(keycode, record) &&
@@ -273,13 +294,13 @@ bool process_record_quantum(keyrecord_t *record) {
             process_space_cadet(keycode, record) &&
 #endif
 #ifdef MAGIC_KEYCODE_ENABLE
-            process_magic(keycode, record) &&
+            PROCESS_KEYCODE_RANGE(MAGIC_SWAP_CONTROL_CAPSLOCK, MAGIC_EE_HANDS_RIGHT, process_magic) &&
 #endif
 #ifdef GRAVE_ESC_ENABLE
-            process_grave_esc(keycode, record) &&
+            PROCESS_KEYCODE_RANGE(GRAVE_ESC, GRAVE_ESC, process_grave_esc) &&
 #endif
 #if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
-            process_rgb(keycode, record) &&
+            PROCESS_KEYCODE_RANGE(RGB_TOG, RGB_MODE_RGBTEST, process_rgb) &&
 #endif
             true)) {
         return false;
@@ -426,9 +447,6 @@ __attribute__((weak)) const uint8_t ascii_to_keycode_lut[128] PROGMEM = {
 
 // clang-format on
 
-// Note: we bit-pack in "reverse" order to optimize loading
-#define PGM_LOADBIT(mem, pos) ((pgm_read_byte(&((mem)[(pos) / 8])) >> ((pos) % 8)) & 0x01)
-
 void send_string(const char *str) { send_string_with_delay(str, 0); }
 
 void send_string_P(const char *str) { send_string_with_delay_P(str, 0); }
@@ -674,6 +692,10 @@ void matrix_scan_quantum() {
     dip_switch_read(false);
 #endif
 
+#ifdef SEND_STRING_ASYNC_ENABLE
+    send_string_async_task();
+#endif
+
     matrix_scan_kb();
 }
 
@@ -182,6 +182,10 @@ extern layer_state_t layer_state;
 #    include "wpm.h"
 #endif
 
+#ifdef SEND_STRING_ASYNC_ENABLE
+#    include "send_string_async.h"
+#endif
+
 // Function substitutions to ease GPIO manipulation
 #if defined(__AVR__)
 typedef uint8_t pin_t;
@@ -197,6 +201,12 @@ typedef uint8_t pin_t;
 
 #    define readPin(pin) ((bool)(PINx_ADDRESS(pin) & _BV((pin)&0xF)))
 
+typedef uint8_t port_data_t;
+
+#    define readPort(pin) (PINx_ADDRESS(pin))
+#    define getPinPort(pin) ((pin) >> PORT_SHIFTER)
+#    define getPinBit(pin) ((pin)&0xF)
+
 #elif defined(PROTOCOL_CHIBIOS)
 typedef ioline_t pin_t;
 
@@ -210,6 +220,12 @@ typedef ioline_t pin_t;
 #    define writePin(pin, level) ((level) ? writePinHigh(pin) : writePinLow(pin))
 
 #    define readPin(pin) palReadLine(pin)
+
+typedef ioportmask_t port_data_t;
+
+#    define readPort(pin) palReadPort(PAL_PORT(pin))
+#    define getPinPort(pin) PAL_PORT(pin)
+#    define getPinBit(pin) PAL_PAD(pin)
 #endif
 
 #define SEND_STRING(string) send_string_P(PSTR(string))
@@ -231,6 +247,9 @@ extern const uint8_t ascii_to_altgr_lut[16];
     | ((h) ? 1 : 0) << 7 )
 // clang-format on
 
+// Note: we bit-pack in "reverse" order to optimize loading
+#define PGM_LOADBIT(mem, pos) ((pgm_read_byte(&((mem)[(pos) / 8])) >> ((pos) % 8)) & 0x01)
+
 void send_string(const char *str);
 void send_string_with_delay(const char *str, uint8_t interval);
 void send_string_P(const char *str);
@@ -31,10 +31,88 @@ const point_t k_rgb_matrix_center = {112, 32};
 const point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 #endif
 
+// Set at the start of a frame when anything a static effect depends on changed
+// since the last frame, see RGB_MATRIX_STATIC_EFFECT()
+static bool rgb_static_redraw = true;
+
+// On AVR the tables cost more RAM than most boards can spare
+#if !defined(RGB_MATRIX_GEOMETRY_CACHE) && !defined(RGB_MATRIX_NO_GEOMETRY_CACHE) && !defined(__AVR__)
+#    define RGB_MATRIX_GEOMETRY_CACHE
+#endif
+
+// LED geometry used by the spatial runners: distance and angle of each LED
+// from the center, and distances from recently hit LEDs to every LED. With
+// RGB_MATRIX_GEOMETRY_CACHE these are table lookups instead of a sqrt16 and
+// an atan2_8 per LED per frame.
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+static uint8_t led_center_dist[DRIVER_LED_TOTAL];
+static uint8_t led_center_angle[DRIVER_LED_TOTAL];
+
+static inline uint8_t rgb_matrix_led_dist(uint8_t i) { return led_center_dist[i]; }
+static inline uint8_t rgb_matrix_led_angle(uint8_t i) { return led_center_angle[i]; }
+
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+// One row per remembered hit, so a row is computed once per key press
+// instead of once per frame
+static uint8_t hit_row_led[LED_HITS_TO_REMEMBER];
+static bool    hit_row_used[LED_HITS_TO_REMEMBER];
+static uint8_t hit_rows[LED_HITS_TO_REMEMBER][DRIVER_LED_TOTAL];
+
+static void rgb_matrix_hit_rows_begin(void) { memset(hit_row_used, 0, sizeof(hit_row_used)); }
+
+// Distances from the given LED to every LED. Rows handed out since the last
+// rgb_matrix_hit_rows_begin() stay valid.
+static const uint8_t *rgb_matrix_hit_dist_row(uint8_t led) {
+    uint8_t row = LED_HITS_TO_REMEMBER;
+    for (uint8_t r = 0; r < LED_HITS_TO_REMEMBER; r++) {
+        if (hit_row_led[r] == led) {
+            hit_row_used[r] = true;
+            return hit_rows[r];
+        }
+        if (!hit_row_used[r] && (row == LED_HITS_TO_REMEMBER || hit_row_led[r] == NO_LED)) {
+            row = r;
+        }
+    }
+
+    hit_row_led[row]  = led;
+    hit_row_used[row] = true;
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx        = g_led_config.point[i].x - g_led_config.point[led].x;
+        int16_t dy        = g_led_config.point[i].y - g_led_config.point[led].y;
+        hit_rows[row][i]  = sqrt16(dx * dx + dy * dy);
+    }
+    return hit_rows[row];
+}
+#    endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+
+static void rgb_matrix_geometry_init(void) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx          = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy          = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        led_center_dist[i]  = sqrt16(dx * dx + dy * dy);
+        led_center_angle[i] = atan2_8(dy, dx);
+    }
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+    memset(hit_row_led, NO_LED, sizeof(hit_row_led));
+#    endif
+}
+#else
+static inline uint8_t rgb_matrix_led_dist(uint8_t i) {
+    int16_t dx = g_led_config.point[i].x - k_rgb_matrix_center.x;
+    int16_t dy = g_led_config.point[i].y - k_rgb_matrix_center.y;
+    return sqrt16(dx * dx + dy * dy);
+}
+
+static inline uint8_t rgb_matrix_led_angle(uint8_t i) { return atan2_8(g_led_config.point[i].y - k_rgb_matrix_center.y, g_led_config.point[i].x - k_rgb_matrix_center.x); }
+
+#    define rgb_matrix_geometry_init()
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
+
 // Generic effect runners
 #include "rgb_matrix_runners/effect_runner_dx_dy_dist.h"
 #include "rgb_matrix_runners/effect_runner_dx_dy.h"
 #include "rgb_matrix_runners/effect_runner_i.h"
+#include "rgb_matrix_runners/effect_runner_polar.h"
 #include "rgb_matrix_runners/effect_runner_sin_cos_i.h"
 #include "rgb_matrix_runners/effect_runner_reactive.h"
 #include "rgb_matrix_runners/effect_runner_reactive_splash.h"
@@ -164,9 +242,24 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
 
 void rgb_matrix_update_pwm_buffers(void) { rgb_matrix_driver.flush(); }
 
-void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color(index, red, green, blue); }
+// Colors set outside of the effect (indicators, user code) draw over static
+// effects, which then have to redraw once those stop
+static bool rgb_effect_rendering = false;
+static bool rgb_overlay_drawn    = false;
 
-void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color_all(red, green, blue); }
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (!rgb_effect_rendering) {
+        rgb_overlay_drawn = true;
+    }
+    rgb_matrix_driver.set_color(index, red, green, blue);
+}
+
+void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+    if (!rgb_effect_rendering) {
+        rgb_overlay_drawn = true;
+    }
+    rgb_matrix_driver.set_color_all(red, green, blue);
+}
 
 bool process_rgb_matrix(uint16_t keycode, keyrecord_t *record) {
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
@@ -252,6 +345,9 @@ static uint8_t         rgb_last_enable   = UINT8_MAX;
 static uint8_t         rgb_last_effect   = UINT8_MAX;
 static effect_params_t rgb_effect_params = {0, 0xFF};
 static rgb_task_states rgb_task_state    = SYNCING;
+static HSV             rgb_drawn_hsv;
+static uint8_t         rgb_drawn_speed;
+static led_flags_t     rgb_drawn_flags;
 
 static void rgb_task_timers(void) {
     // Update double buffer timers
@@ -293,6 +389,14 @@ static void rgb_task_start(void) {
     g_last_hit_tracker = last_hit_buffer;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
+    // static effects only redraw when their inputs changed
+    HSV hsv           = rgb_matrix_config.hsv;
+    rgb_static_redraw = rgb_overlay_drawn || hsv.h != rgb_drawn_hsv.h || hsv.s != rgb_drawn_hsv.s || hsv.v != rgb_drawn_hsv.v || rgb_matrix_config.speed != rgb_drawn_speed || rgb_effect_params.flags != rgb_drawn_flags;
+    rgb_overlay_drawn = false;
+    rgb_drawn_hsv     = hsv;
+    rgb_drawn_speed   = rgb_matrix_config.speed;
+    rgb_drawn_flags   = rgb_effect_params.flags;
+
     // next task
     rgb_task_state = RENDERING;
 }
@@ -300,6 +404,7 @@ static void rgb_task_start(void) {
 static void rgb_task_render(uint8_t effect) {
     bool rendering         = false;
     rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
+    rgb_effect_rendering   = true;
 
     // each effect can opt to do calculations
     // and/or request PWM buffer updates.
@@ -338,9 +443,11 @@ static void rgb_task_render(uint8_t effect) {
             rgb_matrix_test();
             rgb_task_state = FLUSHING;
         }
+            rgb_effect_rendering = false;
             return;
     }
 
+    rgb_effect_rendering = false;
     rgb_effect_params.iter++;
 
     // next task
@@ -404,6 +511,7 @@ __attribute__((weak)) void rgb_matrix_indicators_user(void) {}
 
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
+    rgb_matrix_geometry_init();
 
     // TODO: put the 1 second startup delay here?
 
@@ -58,6 +58,12 @@
 #define RGB_MATRIX_TEST_LED_FLAGS() \
     if (!HAS_ANY_FLAGS(g_led_config.flags[i], params->flags)) continue
 
+// For effects that only depend on rgb_matrix_config and the LED flags: once
+// drawn, the effect is skipped until one of those changes or something else
+// drew over it, and the following flush has nothing to send.
+#define RGB_MATRIX_STATIC_EFFECT() \
+    if (!params->init && !rgb_static_redraw) return false
+
 enum rgb_matrix_effects {
     RGB_MATRIX_NONE = 0,
 
@@ -4,6 +4,7 @@ RGB_MATRIX_EFFECT(ALPHAS_MODS)
 
 // alphas = color1, mods = color2
 bool ALPHAS_MODS(effect_params_t* params) {
+    RGB_MATRIX_STATIC_EFFECT();
     RGB_MATRIX_USE_LIMITS(led_min, led_max);
 
     HSV hsv  = rgb_matrix_config.hsv;
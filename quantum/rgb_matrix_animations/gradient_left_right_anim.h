@@ -3,6 +3,7 @@ RGB_MATRIX_EFFECT(GRADIENT_LEFT_RIGHT)
 #    ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 bool GRADIENT_LEFT_RIGHT(effect_params_t* params) {
+    RGB_MATRIX_STATIC_EFFECT();
     RGB_MATRIX_USE_LIMITS(led_min, led_max);
 
     HSV     hsv   = rgb_matrix_config.hsv;
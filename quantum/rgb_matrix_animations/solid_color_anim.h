@@ -2,6 +2,7 @@ RGB_MATRIX_EFFECT(SOLID_COLOR)
 #ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 bool SOLID_COLOR(effect_params_t* params) {
+    RGB_MATRIX_STATIC_EFFECT();
     RGB_MATRIX_USE_LIMITS(led_min, led_max);
 
     RGB rgb = hsv_to_rgb(rgb_matrix_config.hsv);
@@ -100,15 +100,30 @@ const rgb_matrix_driver_t rgb_matrix_driver = {
 // LED color buffer
 LED_TYPE led[DRIVER_LED_TOTAL];
 
-static void init(void) {}
+// Whether an LED changed since the last flush. A changed frame is always sent
+// in full, as some drivers (ws2812_spi) always clock out their whole buffer.
+static bool led_dirty;
+
+static void init(void) { led_dirty = true; }
 
 static void flush(void) {
+    if (!led_dirty) {
+        return;
+    }
     // Assumes use of RGB_DI_PIN
     ws2812_setleds(led, DRIVER_LED_TOTAL);
+    led_dirty = false;
 }
 
 // Set an led in the buffer to a color
 static inline void setled(int i, uint8_t r, uint8_t g, uint8_t b) {
+    // (not with RGBW, the conversion rewrites r, g and b)
+#    ifndef RGBW
+    if (led[i].r == r && led[i].g == g && led[i].b == b) {
+        return;
+    }
+#    endif
+    led_dirty = true;
     led[i].r = r;
     led[i].g = g;
     led[i].b = b;
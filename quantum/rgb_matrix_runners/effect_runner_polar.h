@@ -0,0 +1,16 @@
+#pragma once
+
+typedef HSV (*polar_f)(HSV hsv, uint8_t dist, uint8_t angle, uint8_t time);
+
+// dist and angle (as atan2_8) of the LED from k_rgb_matrix_center
+bool effect_runner_polar(effect_params_t* params, polar_f effect_func) {
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+
+    uint8_t time = scale16by8(g_rgb_counters.tick, rgb_matrix_config.speed / 2);
+    for (uint8_t i = led_min; i < led_max; i++) {
+        RGB_MATRIX_TEST_LED_FLAGS();
+        RGB rgb = hsv_to_rgb(effect_func(rgb_matrix_config.hsv, rgb_matrix_led_dist(i), rgb_matrix_led_angle(i), time));
+        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+    }
+    return led_max < DRIVER_LED_TOTAL;
+}
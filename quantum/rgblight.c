@@ -113,9 +113,21 @@ static uint8_t effect_start_pos   = 0;
 static uint8_t effect_end_pos     = RGBLED_NUM;
 static uint8_t effect_num_leds    = RGBLED_NUM;
 
+#ifndef RGBLIGHT_CUSTOM_DRIVER
+/* The frame last sent to the LEDs, in chain order. led[] is the buffer
+ * effects render into, rgblight_set() maps it onto this frame and only sends
+ * it when something changed.
+ */
+static LED_TYPE led_frame[RGBLED_NUM];
+static bool     led_frame_valid = false;
+#endif
+
 void rgblight_set_clipping_range(uint8_t start_pos, uint8_t num_leds) {
     clipping_start_pos = start_pos;
     clipping_num_leds  = num_leds;
+#ifndef RGBLIGHT_CUSTOM_DRIVER
+    led_frame_valid = false;
+#endif
 }
 
 void rgblight_set_effect_range(uint8_t start_pos, uint8_t num_leds) {
@@ -686,22 +698,30 @@ void rgblight_set(void) {
         }
     }
 
+    // A changed frame is always sent in full: some drivers (ws2812_spi)
+    // always clock out their whole buffer, so a shorter send would repaint
+    // the rest of the chain from stale data
+    start_led    = led_frame + clipping_start_pos;
+    bool changed = !led_frame_valid;
+    for (uint8_t i = 0; i < num_leds; i++) {
 #    ifdef RGBLIGHT_LED_MAP
-    LED_TYPE led0[RGBLED_NUM];
-    for (uint8_t i = 0; i < RGBLED_NUM; i++) {
-        led0[i] = led[pgm_read_byte(&led_map[i])];
-    }
-    start_led = led0 + clipping_start_pos;
+        LED_TYPE next = led[pgm_read_byte(&led_map[clipping_start_pos + i])];
 #    else
-    start_led = led + clipping_start_pos;
+        LED_TYPE next = led[clipping_start_pos + i];
 #    endif
-
 #    ifdef RGBW
-    for (uint8_t i = 0; i < num_leds; i++) {
-        convert_rgb_to_rgbw(&start_led[i]);
-    }
+        convert_rgb_to_rgbw(&next);
 #    endif
-    ws2812_setleds(start_led, num_leds);
+        if (memcmp(&next, &start_led[i], sizeof(LED_TYPE)) != 0) {
+            start_led[i] = next;
+            changed      = true;
+        }
+    }
+    led_frame_valid = true;
+
+    if (changed) {
+        ws2812_setleds(start_led, num_leds);
+    }
 }
 #endif
 
@@ -958,13 +978,8 @@ void rgblight_effect_rainbow_mood(animation_status_t *anim) {
 __attribute__((weak)) const uint8_t RGBLED_RAINBOW_SWIRL_INTERVALS[] PROGMEM = {100, 50, 20};
 
 void rgblight_effect_rainbow_swirl(animation_status_t *anim) {
-    uint8_t hue;
-    uint8_t i;
-
-    for (i = 0; i < effect_num_leds; i++) {
-        hue = (RGBLIGHT_RAINBOW_SWIRL_RANGE / effect_num_leds * i + anim->current_hue);
-        sethsv(hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[i + effect_start_pos]);
-    }
+    HSV hsv = {anim->current_hue, rgblight_config.sat, MIN(rgblight_config.val, RGBLIGHT_LIMIT_VAL)};
+    hsv_to_rgb_ramp(hsv, RGBLIGHT_RAINBOW_SWIRL_RANGE / effect_num_leds, led + effect_start_pos, effect_num_leds);
     rgblight_set();
 
     if (anim->delta % 2) {
@@ -1050,6 +1065,7 @@ void rgblight_effect_knight(animation_status_t *anim) {
     static int8_t high_bound = RGBLIGHT_EFFECT_KNIGHT_LENGTH - 1;
     static int8_t increment  = 1;
     uint8_t       i, cur;
+    LED_TYPE      color;
 
 #    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
     if (anim->pos == 0) {  // restart signal
@@ -1069,11 +1085,12 @@ void rgblight_effect_knight(animation_status_t *anim) {
 #    endif
     }
     // Determine which LEDs should be lit up
+    sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, &color);
     for (i = 0; i < RGBLIGHT_EFFECT_KNIGHT_LED_NUM; i++) {
         cur = (i + RGBLIGHT_EFFECT_KNIGHT_OFFSET) % effect_num_leds + effect_start_pos;
 
         if (i >= low_bound && i <= high_bound) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[cur]);
+            led[cur] = color;
         } else {
             led[cur].r = 0;
             led[cur].g = 0;
@@ -1103,13 +1120,14 @@ void rgblight_effect_knight(animation_status_t *anim) {
 
 #ifdef RGBLIGHT_EFFECT_CHRISTMAS
 void rgblight_effect_christmas(animation_status_t *anim) {
-    uint8_t hue;
-    uint8_t i;
+    LED_TYPE colors[2];
+    uint8_t  i;
 
+    sethsv(0, rgblight_config.sat, rgblight_config.val, &colors[0]);
+    sethsv(85, rgblight_config.sat, rgblight_config.val, &colors[1]);
     anim->current_offset = (anim->current_offset + 1) % 2;
     for (i = 0; i < effect_num_leds; i++) {
-        hue = 0 + ((i / RGBLIGHT_EFFECT_CHRISTMAS_STEP + anim->current_offset) % 2) * 85;
-        sethsv(hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[i + effect_start_pos]);
+        led[i + effect_start_pos] = colors[(i / RGBLIGHT_EFFECT_CHRISTMAS_STEP + anim->current_offset) % 2];
     }
     rgblight_set();
 }
@@ -1148,14 +1166,18 @@ void rgblight_effect_rgbtest(animation_status_t *anim) {
 
 #ifdef RGBLIGHT_EFFECT_ALTERNATING
 void rgblight_effect_alternating(animation_status_t *anim) {
+    LED_TYPE on, off;
+    sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, &on);
+    sethsv(rgblight_config.hue, rgblight_config.sat, 0, &off);
+
     for (int i = 0; i < effect_num_leds; i++) {
         LED_TYPE *ledp = led + i + effect_start_pos;
         if (i < effect_num_leds / 2 && anim->pos) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, ledp);
+            *ledp = on;
         } else if (i >= effect_num_leds / 2 && !anim->pos) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, ledp);
+            *ledp = on;
         } else {
-            sethsv(rgblight_config.hue, rgblight_config.sat, 0, ledp);
+            *ledp = off;
         }
     }
     rgblight_set();
@@ -0,0 +1,239 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "send_string_async.h"
+#include <ctype.h>
+
+#if SEND_STRING_ASYNC_QUEUE_SIZE > 255
+#    error "SEND_STRING_ASYNC_QUEUE_SIZE must not be larger than 255"
+#endif
+
+/* A queued operation is either an ASCII character or one of the SS_*_CODE
+ * operations of SEND_STRING with its keycode or delay.
+ */
+#define SS_CHAR_CODE 0
+
+typedef struct {
+    uint8_t code;
+    uint8_t arg;
+} ss_op_t;
+
+static ss_op_t queue[SEND_STRING_ASYNC_QUEUE_SIZE];
+static uint8_t queue_head;
+static uint8_t queue_count;
+
+// The single presses, releases and delays of the operation being sent
+static ss_op_t  steps[7];
+static uint8_t  steps_len;
+static uint8_t  steps_pos;
+static uint16_t delay_timer;
+static uint8_t  delay_ms;
+
+static bool queue_push(uint8_t code, uint8_t arg) {
+    if (queue_count >= SEND_STRING_ASYNC_QUEUE_SIZE) {
+        return false;
+    }
+    queue[(queue_head + queue_count) % SEND_STRING_ASYNC_QUEUE_SIZE] = (ss_op_t){code, arg};
+    queue_count++;
+    return true;
+}
+
+static ss_op_t queue_pop(void) {
+    ss_op_t op = queue[queue_head];
+    queue_head = (queue_head + 1) % SEND_STRING_ASYNC_QUEUE_SIZE;
+    queue_count--;
+    return op;
+}
+
+static bool queue_push_delay(uint16_t ms) {
+    for (; ms > UINT8_MAX; ms -= UINT8_MAX) {
+        if (!queue_push(SS_DELAY_CODE, UINT8_MAX)) {
+            return false;
+        }
+    }
+    return !ms || queue_push(SS_DELAY_CODE, ms);
+}
+
+static char read_char(const char *str, bool progmem) { return progmem ? pgm_read_byte(str) : *str; }
+
+/* Queues every operation of the string, or nothing at all if they don't
+ * fit.
+ */
+static bool queue_string(const char *str, uint8_t interval, bool progmem) {
+    uint8_t count = queue_count;
+    bool    ok    = true;
+
+    while (ok) {
+        char ascii_code = read_char(str, progmem);
+        if (!ascii_code) break;
+        if (ascii_code == SS_QMK_PREFIX) {
+            ascii_code = read_char(++str, progmem);
+            if (ascii_code == SS_TAP_CODE || ascii_code == SS_DOWN_CODE || ascii_code == SS_UP_CODE) {
+                ok = queue_push(ascii_code, read_char(++str, progmem));
+            } else if (ascii_code == SS_DELAY_CODE) {
+                uint16_t ms      = 0;
+                uint8_t  keycode = read_char(++str, progmem);
+                while (isdigit(keycode)) {
+                    ms *= 10;
+                    ms += keycode - '0';
+                    keycode = read_char(++str, progmem);
+                }
+                ok = queue_push_delay(ms);
+            }
+        } else {
+            ok = queue_push(SS_CHAR_CODE, ascii_code);
+        }
+        ++str;
+        if (ok && interval) {
+            ok = queue_push(SS_DELAY_CODE, interval);
+        }
+    }
+
+    if (!ok) {
+        queue_count = count;
+    }
+    return ok;
+}
+
+bool send_string_async(const char *str) { return queue_string(str, 0, false); }
+
+bool send_string_with_delay_async(const char *str, uint8_t interval) { return queue_string(str, interval, false); }
+
+bool send_string_async_P(const char *str) { return queue_string(str, 0, true); }
+
+bool send_string_with_delay_async_P(const char *str, uint8_t interval) { return queue_string(str, interval, true); }
+
+bool send_char_async(char ascii_code) { return queue_push(SS_CHAR_CODE, ascii_code); }
+
+bool tap_code_async(uint8_t code) { return queue_push(SS_TAP_CODE, code); }
+
+bool register_code_async(uint8_t code) { return queue_push(SS_DOWN_CODE, code); }
+
+bool unregister_code_async(uint8_t code) { return queue_push(SS_UP_CODE, code); }
+
+bool wait_ms_async(uint16_t ms) {
+    uint8_t count = queue_count;
+    if (!queue_push_delay(ms)) {
+        queue_count = count;
+        return false;
+    }
+    return true;
+}
+
+uint8_t send_string_async_free(void) { return SEND_STRING_ASYNC_QUEUE_SIZE - queue_count; }
+
+bool send_string_async_busy(void) { return queue_count || steps_pos < steps_len || delay_ms; }
+
+static void add_step(uint8_t code, uint8_t arg) { steps[steps_len++] = (ss_op_t){code, arg}; }
+
+/* Splits an operation into the steps send_char() and send_string() would
+ * take, so that each step sends at most one report.
+ */
+static void expand_op(ss_op_t op) {
+    steps_len = 0;
+    steps_pos = 0;
+
+    if (op.code == SS_CHAR_CODE) {
+        uint8_t keycode    = pgm_read_byte(&ascii_to_keycode_lut[op.arg]);
+        bool    is_shifted = PGM_LOADBIT(ascii_to_shift_lut, op.arg);
+        bool    is_altgred = PGM_LOADBIT(ascii_to_altgr_lut, op.arg);
+
+        if (is_shifted) add_step(SS_DOWN_CODE, KC_LSFT);
+        if (is_altgred) add_step(SS_DOWN_CODE, KC_RALT);
+        add_step(SS_DOWN_CODE, keycode);
+#if TAP_CODE_DELAY > 0
+        add_step(SS_DELAY_CODE, TAP_CODE_DELAY);
+#endif
+        add_step(SS_UP_CODE, keycode);
+        if (is_altgred) add_step(SS_UP_CODE, KC_RALT);
+        if (is_shifted) add_step(SS_UP_CODE, KC_LSFT);
+    } else if (op.code == SS_TAP_CODE) {
+        add_step(SS_DOWN_CODE, op.arg);
+        add_step(SS_UP_CODE, op.arg);
+    } else {
+        add_step(op.code, op.arg);
+    }
+}
+
+void send_string_async_task(void) {
+    uint8_t reports = SEND_STRING_ASYNC_REPORTS_PER_SCAN;
+
+    for (;;) {
+        if (delay_ms) {
+            if (timer_elapsed(delay_timer) < delay_ms) {
+                return;
+            }
+            delay_ms = 0;
+        }
+
+        if (steps_pos == steps_len) {
+            if (!queue_count) {
+                return;
+            }
+            ss_op_t op = queue_pop();
+#if defined(AUDIO_ENABLE) && defined(SENDSTRING_BELL)
+            if (op.code == SS_CHAR_CODE && op.arg == '\a') {
+                send_char('\a');
+                continue;
+            }
+#endif
+            expand_op(op);
+        }
+
+        // a delay starts right away, even once this scan's reports are used up;
+        // a report waits for room in the host driver's queue rather than
+        // blocking the scan until the host polls
+        ss_op_t step = steps[steps_pos];
+        if (step.code != SS_DELAY_CODE) {
+            if (!reports || !host_keyboard_queue_free()) {
+                return;
+            }
+            reports--;
+        }
+        steps_pos++;
+
+        switch (step.code) {
+            case SS_DOWN_CODE:
+                register_code(step.arg);
+                break;
+            case SS_UP_CODE:
+                unregister_code(step.arg);
+                break;
+            case SS_DELAY_CODE:
+                delay_timer = timer_read();
+                delay_ms    = step.arg;
+                break;
+        }
+    }
+}
+
+/* Drops everything still queued. The releases among it are sent right
+ * away, so no key pressed by the queue is left held down.
+ */
+void send_string_async_cancel(void) {
+    for (; steps_pos < steps_len; steps_pos++) {
+        if (steps[steps_pos].code == SS_UP_CODE) {
+            unregister_code(steps[steps_pos].arg);
+        }
+    }
+    while (queue_count) {
+        ss_op_t op = queue_pop();
+        if (op.code == SS_UP_CODE) {
+            unregister_code(op.arg);
+        }
+    }
+    delay_ms = 0;
+}
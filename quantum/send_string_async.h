@@ -0,0 +1,51 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+// Number of queued operations (a character, a tap, a press, a release or a delay of up to 255 ms)
+#ifndef SEND_STRING_ASYNC_QUEUE_SIZE
+#    define SEND_STRING_ASYNC_QUEUE_SIZE 64
+#endif
+
+// Keyboard reports sent per matrix scan while the queue drains
+#ifndef SEND_STRING_ASYNC_REPORTS_PER_SCAN
+#    define SEND_STRING_ASYNC_REPORTS_PER_SCAN 2
+#endif
+
+#define SEND_STRING_ASYNC(string) send_string_async_P(PSTR(string))
+#define SEND_STRING_ASYNC_DELAY(string, interval) send_string_with_delay_async_P(PSTR(string), interval)
+
+/* The queueing functions return false, and queue nothing, if the whole
+ * string or operation doesn't fit in the free space of the queue.
+ */
+bool send_string_async(const char *str);
+bool send_string_with_delay_async(const char *str, uint8_t interval);
+bool send_string_async_P(const char *str);
+bool send_string_with_delay_async_P(const char *str, uint8_t interval);
+
+bool send_char_async(char ascii_code);
+bool tap_code_async(uint8_t code);
+bool register_code_async(uint8_t code);
+bool unregister_code_async(uint8_t code);
+bool wait_ms_async(uint16_t ms);
+
+uint8_t send_string_async_free(void);
+bool    send_string_async_busy(void);
+void    send_string_async_cancel(void);
+void    send_string_async_task(void);
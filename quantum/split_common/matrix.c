@@ -19,7 +19,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "matrix.h"
 #include "debounce.h"
+#include "scan_profile.h"
 #include "quantum.h"
+#include "matrix_port_scan.h"
 #include "split_util.h"
 #include "config.h"
 #include "transport.h"
@@ -99,6 +101,9 @@ static void init_pins(void) {
     for (uint8_t x = 0; x < MATRIX_COLS; x++) {
         setPinInputHigh(col_pins[x]);
     }
+#        ifdef MATRIX_PORT_SCAN
+    matrix_port_scan_init(col_pins);
+#        endif
 }
 
 static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
@@ -112,6 +117,9 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     select_row(current_row);
     matrix_io_delay();
 
+#        ifdef MATRIX_PORT_SCAN
+    current_matrix[current_row] = matrix_port_scan_read_cols();
+#        else
     // For each col...
     for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
         // Select the col pin to read (active low)
@@ -120,6 +128,7 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
         // Populate the matrix row with the state of the col pin
         current_matrix[current_row] |= pin_state ? 0 : (MATRIX_ROW_SHIFTER << col_index);
     }
+#        endif
 
     // Unselect row
     unselect_row(current_row);
@@ -277,7 +286,9 @@ uint8_t matrix_scan(void) {
     }
 #endif
 
+    scan_profile_begin(SCAN_PROFILE_DEBOUNCE);
     debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed);
+    scan_profile_end(SCAN_PROFILE_DEBOUNCE);
 
     matrix_post_scan();
     return (uint8_t)changed;
@@ -16,4 +16,8 @@
 // When using serial and RGBLIGHT_SPLIT need separate transaction
 #        define SERIAL_USE_MULTI_TRANSACTION
 #    endif
+// The dirty section sync polls a status transaction before the matrix one
+#    if defined(SPLIT_TRANSPORT_DIRTY_SYNC) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
 #endif
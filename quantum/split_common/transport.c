@@ -21,12 +21,44 @@ static pin_t encoders_pad[] = ENCODERS_PAD_A;
 #    define NUMBER_OF_ENCODERS (sizeof(encoders_pad) / sizeof(pin_t))
 #endif
 
+#ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+// Bump when the layout of the slave status header or the buffers changes, so
+// halves flashed with different firmware refuse to talk instead of misreading.
+#    define SPLIT_TRANSPORT_VERSION 2
+
+// The slave bumps a section's sequence number every time it changes that
+// section, and the master only fetches sections whose number moved since its
+// last successful read. The master never has to clear anything on the slave,
+// so a lost transfer just means the section is fetched again next scan.
+typedef struct _split_status_t {
+    uint8_t version;
+    uint8_t matrix_seq;
+#    ifdef ENCODER_ENABLE
+    uint8_t encoder_seq;
+#    endif
+} split_status_t;
+
+static bool split_matrix_changed(volatile matrix_row_t *dst, const matrix_row_t *src) {
+    bool changed = false;
+    for (int i = 0; i < ROWS_PER_HAND; ++i) {
+        if (dst[i] != src[i]) {
+            dst[i]  = src[i];
+            changed = true;
+        }
+    }
+    return changed;
+}
+#endif
+
 #if defined(USE_I2C)
 
 #    include "i2c_master.h"
 #    include "i2c_slave.h"
 
 typedef struct _I2C_slave_buffer_t {
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    split_status_t status;
+#    endif
     matrix_row_t smatrix[ROWS_PER_HAND];
     uint8_t      backlight_level;
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
@@ -47,6 +79,7 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 #    define I2C_KEYMAP_START offsetof(I2C_slave_buffer_t, smatrix)
 #    define I2C_ENCODER_START offsetof(I2C_slave_buffer_t, encoder_state)
 #    define I2C_WPM_START offsetof(I2C_slave_buffer_t, current_wpm)
+#    define I2C_STATUS_START offsetof(I2C_slave_buffer_t, status)
 
 #    define TIMEOUT 100
 
@@ -54,9 +87,31 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 #        define SLAVE_I2C_ADDRESS 0x32
 #    endif
 
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+static split_status_t last_status;
+static bool           status_valid = false;
+#    endif
+
 // Get rows from other half over i2c
 bool transport_master(matrix_row_t matrix[]) {
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    split_status_t status;
+    if (i2c_readReg(SLAVE_I2C_ADDRESS, I2C_STATUS_START, (void *)&status, sizeof(status), TIMEOUT) < 0 || status.version != SPLIT_TRANSPORT_VERSION) {
+        // force a full resync once the other half answers again
+        status_valid = false;
+        return false;
+    }
+
+    if (!status_valid || status.matrix_seq != last_status.matrix_seq) {
+        if (i2c_readReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_START, (void *)matrix, sizeof(i2c_buffer->smatrix), TIMEOUT) < 0) {
+            status_valid = false;
+            return false;
+        }
+        last_status.matrix_seq = status.matrix_seq;
+    }
+#    else
     i2c_readReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_START, (void *)matrix, sizeof(i2c_buffer->smatrix), TIMEOUT);
+#    endif
 
     // write backlight info
 #    ifdef BACKLIGHT_ENABLE
@@ -79,8 +134,19 @@ bool transport_master(matrix_row_t matrix[]) {
 #    endif
 
 #    ifdef ENCODER_ENABLE
+#        ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    if (!status_valid || status.encoder_seq != last_status.encoder_seq) {
+        if (i2c_readReg(SLAVE_I2C_ADDRESS, I2C_ENCODER_START, (void *)i2c_buffer->encoder_state, sizeof(i2c_buffer->encoder_state), TIMEOUT) < 0) {
+            status_valid = false;
+            return false;
+        }
+        last_status.encoder_seq = status.encoder_seq;
+        encoder_update_raw(i2c_buffer->encoder_state);
+    }
+#        else
     i2c_readReg(SLAVE_I2C_ADDRESS, I2C_ENCODER_START, (void *)i2c_buffer->encoder_state, sizeof(i2c_buffer->encoder_state), TIMEOUT);
     encoder_update_raw(i2c_buffer->encoder_state);
+#        endif
 #    endif
 
 #    ifdef WPM_ENABLE
@@ -91,12 +157,25 @@ bool transport_master(matrix_row_t matrix[]) {
         }
     }
 #    endif
+
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    status_valid = true;
+#    endif
     return true;
 }
 
 void transport_slave(matrix_row_t matrix[]) {
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    // Publish the data before the sequence number, so a master that sees the
+    // new number never reads the old rows.
+    volatile split_status_t *status = &i2c_buffer->status;
+    if (split_matrix_changed(i2c_buffer->smatrix, matrix)) {
+        status->matrix_seq++;
+    }
+#    else
     // Copy matrix to I2C buffer
     memcpy((void *)i2c_buffer->smatrix, (void *)matrix, sizeof(i2c_buffer->smatrix));
+#    endif
 
 // Read Backlight Info
 #    ifdef BACKLIGHT_ENABLE
@@ -112,7 +191,16 @@ void transport_slave(matrix_row_t matrix[]) {
 #    endif
 
 #    ifdef ENCODER_ENABLE
+#        ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    uint8_t encoder_state[NUMBER_OF_ENCODERS];
+    encoder_state_raw(encoder_state);
+    if (memcmp(encoder_state, i2c_buffer->encoder_state, sizeof(encoder_state)) != 0) {
+        memcpy(i2c_buffer->encoder_state, encoder_state, sizeof(encoder_state));
+        status->encoder_seq++;
+    }
+#        else
     encoder_state_raw(i2c_buffer->encoder_state);
+#        endif
 #    endif
 
 #    ifdef WPM_ENABLE
@@ -122,13 +210,22 @@ void transport_slave(matrix_row_t matrix[]) {
 
 void transport_master_init(void) { i2c_init(); }
 
-void transport_slave_init(void) { i2c_slave_init(SLAVE_I2C_ADDRESS); }
+void transport_slave_init(void) {
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    i2c_buffer->status.version = SPLIT_TRANSPORT_VERSION;
+#    endif
+    i2c_slave_init(SLAVE_I2C_ADDRESS);
+}
 
 #else  // USE_SERIAL
 
 #    include "serial.h"
 
 typedef struct _Serial_s2m_buffer_t {
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    // the sequence numbers of the rows and encoder state below
+    split_status_t status;
+#    endif
     // TODO: if MATRIX_COLS > 8 change to uint8_t packed_matrix[] for pack/unpack
     matrix_row_t smatrix[ROWS_PER_HAND];
 
@@ -168,14 +265,41 @@ volatile Serial_s2m_buffer_t serial_s2m_buffer = {};
 volatile Serial_m2s_buffer_t serial_m2s_buffer = {};
 uint8_t volatile status0                       = 0;
 
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+volatile split_status_t serial_status = {.version = SPLIT_TRANSPORT_VERSION};
+uint8_t volatile status_sync          = 0;
+#    endif
+
 enum serial_transaction_id {
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    GET_SLAVE_STATUS = 0,
+    GET_SLAVE_MATRIX,
+#    else
     GET_SLAVE_MATRIX = 0,
+#    endif
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     PUT_RGBLIGHT,
 #    endif
 };
 
 SSTD_t transactions[] = {
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    // Sent every scan: the few master to slave bytes out, the slave's section
+    // sequence numbers back.
+    [GET_SLAVE_STATUS] =
+        {
+            (uint8_t *)&status_sync,
+            sizeof(serial_m2s_buffer),
+            (uint8_t *)&serial_m2s_buffer,
+            sizeof(serial_status),
+            (uint8_t *)&serial_status,
+        },
+    // Only sent when the slave reports a changed matrix or encoder.
+    [GET_SLAVE_MATRIX] =
+        {
+            (uint8_t *)&status0, 0, NULL, sizeof(serial_s2m_buffer), (uint8_t *)&serial_s2m_buffer,
+        },
+#    else
     [GET_SLAVE_MATRIX] =
         {
             (uint8_t *)&status0,
@@ -184,6 +308,7 @@ SSTD_t transactions[] = {
             sizeof(serial_s2m_buffer),
             (uint8_t *)&serial_s2m_buffer,
         },
+#    endif
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     [PUT_RGBLIGHT] =
         {
@@ -192,6 +317,18 @@ SSTD_t transactions[] = {
 #    endif
 };
 
+#    ifdef SERIAL_USART_MAX_TRANSACTIONS
+// The USART driver's DMA buffers are sized at compile time
+_Static_assert(TID_LIMIT(transactions) <= SERIAL_USART_MAX_TRANSACTIONS, "Split transport needs more transactions than SERIAL_USART_MAX_TRANSACTIONS");
+_Static_assert(sizeof(serial_m2s_buffer) <= SERIAL_USART_BUFFER_SIZE && sizeof(serial_s2m_buffer) <= SERIAL_USART_BUFFER_SIZE, "Split transport buffers are larger than SERIAL_USART_BUFFER_SIZE");
+#        ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+_Static_assert(sizeof(serial_status) <= SERIAL_USART_BUFFER_SIZE, "Split transport status is larger than SERIAL_USART_BUFFER_SIZE");
+#        endif
+#        if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+_Static_assert(sizeof(serial_rgblight) <= SERIAL_USART_BUFFER_SIZE, "Split RGB Light sync is larger than SERIAL_USART_BUFFER_SIZE");
+#        endif
+#    endif
+
 void transport_master_init(void) { soft_serial_initiator_init(transactions, TID_LIMIT(transactions)); }
 
 void transport_slave_init(void) { soft_serial_target_init(transactions, TID_LIMIT(transactions)); }
@@ -221,6 +358,41 @@ void transport_rgblight_slave(void) {
 #        define transport_rgblight_slave()
 #    endif
 
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+static split_status_t last_status;
+static bool           status_valid = false;
+
+// Fetch the slave half only when one of its sections moved since the last
+// successful read.
+static bool transport_sync_master(void) {
+    if (soft_serial_transaction(GET_SLAVE_STATUS) != TRANSACTION_END || serial_status.version != SPLIT_TRANSPORT_VERSION) {
+        // force a full resync once the other half answers again
+        status_valid = false;
+        return false;
+    }
+
+    bool dirty = !status_valid || serial_status.matrix_seq != last_status.matrix_seq;
+#        ifdef ENCODER_ENABLE
+    dirty |= serial_status.encoder_seq != last_status.encoder_seq;
+#        endif
+    if (!dirty) {
+        return true;
+    }
+
+    // The reply carries the numbers of the data it holds. A driver that hands
+    // back the reply of an earlier exchange (serial_usart.c) gives older
+    // numbers, so the section stays dirty and is fetched again until a reply
+    // taken after the change arrives.
+    if (soft_serial_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
+        status_valid = false;
+        return false;
+    }
+    last_status  = serial_s2m_buffer.status;
+    status_valid = true;
+    return true;
+}
+#    endif
+
 bool transport_master(matrix_row_t matrix[]) {
 #    ifndef SERIAL_USE_MULTI_TRANSACTION
     if (soft_serial_transaction() != TRANSACTION_END) {
@@ -228,9 +400,15 @@ bool transport_master(matrix_row_t matrix[]) {
     }
 #    else
     transport_rgblight_master();
+#        ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    if (!transport_sync_master()) {
+        return false;
+    }
+#        else
     if (soft_serial_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
         return false;
     }
+#        endif
 #    endif
 
     // TODO:  if MATRIX_COLS > 8 change to unpack()
@@ -256,16 +434,33 @@ bool transport_master(matrix_row_t matrix[]) {
 
 void transport_slave(matrix_row_t matrix[]) {
     transport_rgblight_slave();
+#    ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    // Publish the data before the sequence number, so a master that sees the
+    // new number never reads the old rows.
+    if (split_matrix_changed(serial_s2m_buffer.smatrix, matrix)) {
+        serial_s2m_buffer.status.matrix_seq = ++serial_status.matrix_seq;
+    }
+#    else
     // TODO: if MATRIX_COLS > 8 change to pack()
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
         serial_s2m_buffer.smatrix[i] = matrix[i];
     }
+#    endif
 #    ifdef BACKLIGHT_ENABLE
     backlight_set(serial_m2s_buffer.backlight_level);
 #    endif
 
 #    ifdef ENCODER_ENABLE
+#        ifdef SPLIT_TRANSPORT_DIRTY_SYNC
+    uint8_t encoder_state[NUMBER_OF_ENCODERS];
+    encoder_state_raw(encoder_state);
+    if (memcmp(encoder_state, (uint8_t *)serial_s2m_buffer.encoder_state, sizeof(encoder_state)) != 0) {
+        memcpy((uint8_t *)serial_s2m_buffer.encoder_state, encoder_state, sizeof(encoder_state));
+        serial_s2m_buffer.status.encoder_seq = ++serial_status.encoder_seq;
+    }
+#        else
     encoder_state_raw((uint8_t *)serial_s2m_buffer.encoder_state);
+#        endif
 #    endif
 
 #    ifdef WPM_ENABLE
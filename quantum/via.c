@@ -47,6 +47,8 @@
 #include "tmk_core/common/eeprom.h"
 #include "version.h"  // for QMK_BUILDDATE used in EEPROM magic
 
+#include <string.h>
+
 // Forward declare some helpers.
 #if defined(VIA_QMK_BACKLIGHT_ENABLE)
 void via_qmk_backlight_set_value(uint8_t *data);
@@ -184,6 +186,170 @@ bool process_record_via(uint16_t keycode, keyrecord_t *record) {
     return true;
 }
 
+#if defined(VIA_BULK_TRANSFER_ENABLE)
+
+// A bulk write streams the data in reports that the keyboard doesn't answer,
+// so the host doesn't wait a round trip for each one. The data is staged in
+// RAM, and the commit only writes it once it has checked that no report went
+// missing and that the CRC of all data matches.
+static struct {
+    bool     active;
+    uint8_t  target;
+    uint8_t  seq;
+    uint8_t  status;
+    uint16_t offset;  // where the session writes to
+    uint16_t size;
+    uint16_t received;
+    uint8_t  buffer[VIA_BULK_WRITE_SIZE];
+} via_bulk;
+
+// CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF
+static uint16_t via_bulk_crc16(uint16_t crc, const uint8_t *data, uint16_t length) {
+    while (length--) {
+        crc ^= (uint16_t)*data++ << 8;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t via_bulk_target_size(uint8_t target) {
+    switch (target) {
+        case id_bulk_keymap:
+            return DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
+        case id_bulk_macro:
+            return dynamic_keymap_macro_get_buffer_size();
+        default:
+            return 0;
+    }
+}
+
+static void via_bulk_get_buffer(uint8_t target, uint16_t offset, uint16_t size, uint8_t *data) {
+    if (target == id_bulk_keymap) {
+        dynamic_keymap_get_buffer(offset, size, data);
+    } else {
+        dynamic_keymap_macro_get_buffer(offset, size, data);
+    }
+}
+
+// command_data: target, offset (2 bytes), length (2 bytes)
+// returns: status, payload bytes per data report, largest session (2 bytes)
+static void via_bulk_write_begin(uint8_t *command_data, uint8_t length) {
+    uint16_t offset = (command_data[1] << 8) | command_data[2];
+    uint16_t size   = (command_data[3] << 8) | command_data[4];
+
+    command_data[6] = length - 2;
+    command_data[7] = VIA_BULK_WRITE_SIZE >> 8;
+    command_data[8] = VIA_BULK_WRITE_SIZE & 0xFF;
+
+    via_bulk.active = false;
+    if ((uint32_t)offset + size > via_bulk_target_size(command_data[0])) {
+        command_data[5] = via_bulk_bad_range;
+        return;
+    }
+    if (size > VIA_BULK_WRITE_SIZE) {
+        command_data[5] = via_bulk_too_large;
+        return;
+    }
+
+    via_bulk.active   = true;
+    via_bulk.target   = command_data[0];
+    via_bulk.seq      = 0;
+    via_bulk.status   = via_bulk_ok;
+    via_bulk.offset   = offset;
+    via_bulk.size     = size;
+    via_bulk.received = 0;
+
+    command_data[5] = via_bulk_ok;
+}
+
+// command_data: sequence number, payload
+static void via_bulk_write_data(uint8_t *command_data, uint8_t length) {
+    if (!via_bulk.active || via_bulk.status != via_bulk_ok) {
+        return;
+    }
+    if (command_data[0] != via_bulk.seq++) {
+        via_bulk.status = via_bulk_bad_sequence;
+        return;
+    }
+
+    uint16_t size = via_bulk.size - via_bulk.received;
+    if (size > length - 2) {
+        size = length - 2;
+    }
+    memcpy(&via_bulk.buffer[via_bulk.received], &command_data[1], size);
+    via_bulk.received += size;
+}
+
+// command_data: CRC of the data (2 bytes)
+// returns: status
+static void via_bulk_write_commit(uint8_t *command_data) {
+    uint16_t crc = (command_data[0] << 8) | command_data[1];
+
+    if (!via_bulk.active) {
+        command_data[2] = via_bulk_not_started;
+        return;
+    }
+    via_bulk.active = false;
+
+    if (via_bulk.status == via_bulk_ok && via_bulk.received != via_bulk.size) {
+        via_bulk.status = via_bulk_bad_sequence;
+    }
+    if (via_bulk.status == via_bulk_ok && via_bulk_crc16(0xFFFF, via_bulk.buffer, via_bulk.size) != crc) {
+        via_bulk.status = via_bulk_bad_crc;
+    }
+    if (via_bulk.status == via_bulk_ok) {
+        if (via_bulk.target == id_bulk_keymap) {
+            dynamic_keymap_set_buffer(via_bulk.offset, via_bulk.size, via_bulk.buffer);
+        } else {
+            dynamic_keymap_macro_set_buffer(via_bulk.offset, via_bulk.size, via_bulk.buffer);
+        }
+    }
+    command_data[2] = via_bulk.status;
+}
+
+// command_data: target, offset (2 bytes), length (2 bytes)
+// returns: status, CRC of the data (2 bytes), payload bytes per data report,
+// followed by the data reports: id_bulk_read, sequence number, payload
+static void via_bulk_read(uint8_t *data, uint8_t length) {
+    uint8_t *command_data = &(data[1]);
+    uint8_t  target       = command_data[0];
+    uint16_t offset       = (command_data[1] << 8) | command_data[2];
+    uint16_t size         = (command_data[3] << 8) | command_data[4];
+    uint8_t  payload      = length - 2;
+
+    // The staging buffer is needed for the CRC
+    via_bulk.active = false;
+    if ((uint32_t)offset + size > via_bulk_target_size(target)) {
+        command_data[5] = via_bulk_bad_range;
+        raw_hid_send(data, length);
+        return;
+    }
+
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < size; i += VIA_BULK_WRITE_SIZE) {
+        uint16_t block_size = size - i < VIA_BULK_WRITE_SIZE ? size - i : VIA_BULK_WRITE_SIZE;
+        via_bulk_get_buffer(target, offset + i, block_size, via_bulk.buffer);
+        crc = via_bulk_crc16(crc, via_bulk.buffer, block_size);
+    }
+    command_data[5] = via_bulk_ok;
+    command_data[6] = crc >> 8;
+    command_data[7] = crc & 0xFF;
+    command_data[8] = payload;
+    raw_hid_send(data, length);
+
+    uint8_t seq = 0;
+    for (uint16_t i = 0; i < size; i += payload) {
+        data[0] = id_bulk_read;
+        data[1] = seq++;
+        via_bulk_get_buffer(target, offset + i, payload, &data[2]);
+        raw_hid_send(data, length);
+    }
+}
+
+#endif
+
 // Keyboard level code can override this to handle custom messages from VIA.
 // See raw_hid_receive() implementation.
 // DO NOT call raw_hid_send() in the overide function.
@@ -374,6 +540,26 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
             via_eeprom_reset();
             break;
         }
+#if defined(VIA_BULK_TRANSFER_ENABLE)
+        case id_bulk_write_begin: {
+            via_bulk_write_begin(command_data, length);
+            break;
+        }
+        case id_bulk_write_data: {
+            // Not answered, so the host can send the next one right away
+            via_bulk_write_data(command_data, length);
+            return;
+        }
+        case id_bulk_write_commit: {
+            via_bulk_write_commit(command_data);
+            break;
+        }
+        case id_bulk_read: {
+            // Sends its own reply, followed by the data
+            via_bulk_read(data, length);
+            return;
+        }
+#endif
         case id_bootloader_jump: {
             // Need to send data back before the jump
             // Informs host that the command is handled
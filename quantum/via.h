@@ -17,6 +17,7 @@
 #pragma once
 
 #include <tmk_core/common/eeconfig.h>  // for EECONFIG_SIZE
+#include "action.h"                    // for keyrecord_t
 
 // Keyboard level code can change where VIA stores the magic.
 // The magic is the build date YYMMDD encoded as BCD in 3 bytes,
@@ -54,6 +55,18 @@
 #    define VIA_EEPROM_CUSTOM_CONFIG_SIZE 0
 #endif
 
+// Largest bulk write session. The data is held in RAM until its CRC has
+// been checked, so a failed session leaves the EEPROM untouched. Only a
+// session is atomic: a keymap larger than this takes several sessions, and
+// those committed before a failed one stay written.
+#ifndef VIA_BULK_WRITE_SIZE
+#    if defined(__AVR__)
+#        define VIA_BULK_WRITE_SIZE 128
+#    else
+#        define VIA_BULK_WRITE_SIZE 512
+#    endif
+#endif
+
 // This is changed only when the command IDs change,
 // so VIA Configurator can detect compatible firmware.
 #define VIA_PROTOCOL_VERSION 0x0009
@@ -78,9 +91,43 @@ enum via_command_id {
     id_dynamic_keymap_get_layer_count       = 0x11,
     id_dynamic_keymap_get_buffer            = 0x12,
     id_dynamic_keymap_set_buffer            = 0x13,
+    id_bulk_write_begin                     = 0x14,
+    id_bulk_write_data                      = 0x15,
+    id_bulk_write_commit                    = 0x16,
+    id_bulk_read                            = 0x17,
     id_unhandled                            = 0xFF,
 };
 
+// Bulk transfers move a whole keymap or macro buffer with one reply per
+// session instead of one per 28 bytes. They are only handled with
+// VIA_BULK_TRANSFER_ENABLE defined, otherwise they get id_unhandled like
+// any unknown command.
+//
+// Writing: id_bulk_write_begin (target, offset, length), then as many
+// id_bulk_write_data reports (sequence number, payload) as needed without
+// waiting for replies, then id_bulk_write_commit (CRC-16/CCITT-FALSE of the
+// data), whose reply carries the status. The begin reply also carries the
+// largest session, VIA_BULK_WRITE_SIZE; longer writes are split into several
+// sessions. Nothing of a session is written to EEPROM unless its commit
+// succeeds, but there is no commit across sessions, so after a failure the
+// host has to write the whole range again.
+//
+// Reading: id_bulk_read (target, offset, length) replies with the status
+// and CRC, followed by the id_bulk_read data reports.
+enum via_bulk_target {
+    id_bulk_keymap = 0x00,  // same layout as id_dynamic_keymap_get_buffer
+    id_bulk_macro  = 0x01,  // same layout as id_dynamic_keymap_macro_get_buffer
+};
+
+enum via_bulk_status {
+    via_bulk_ok           = 0x00,
+    via_bulk_bad_range    = 0x01,  // offset and length don't fit the target
+    via_bulk_bad_sequence = 0x02,  // a data report was lost, or data is missing
+    via_bulk_bad_crc      = 0x03,
+    via_bulk_not_started  = 0x04,  // commit without a write session
+    via_bulk_too_large    = 0x05,  // longer than VIA_BULK_WRITE_SIZE
+};
+
 enum via_keyboard_value_id {
     id_uptime              = 0x01,  //
     id_layout_options      = 0x02,
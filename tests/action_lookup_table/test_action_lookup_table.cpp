@@ -0,0 +1,90 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "keymap.h"
+}
+
+#define KEYS_PER_LAYER (MATRIX_ROWS * MATRIX_COLS)
+
+// Every key of the keymap gets a different keycode, starting at keycode_base
+static uint16_t keycode_base;
+
+extern "C" uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) { return keycode_base + layer * KEYS_PER_LAYER + key.row * MATRIX_COLS + key.col; }
+
+class ActionLookupTable : public TestFixture {
+   public:
+    ActionLookupTable() { saved_config = keymap_config; }
+    ~ActionLookupTable() {
+        keymap_config = saved_config;
+        keycode_base  = 0;
+        action_lookup_table_clear();
+    }
+
+    keymap_config_t saved_config;
+};
+
+TEST_F(ActionLookupTable, EveryKeycodeMatchesTheSwitch) {
+    unsigned mismatches = 0;
+
+    for (uint32_t base = 0; base <= 0xFFFF; base += ACTION_LOOKUP_TABLE_LAYERS * KEYS_PER_LAYER) {
+        keycode_base = base;
+        action_lookup_table_clear();
+        for (uint8_t layer = 0; layer < ACTION_LOOKUP_TABLE_LAYERS; layer++) {
+            for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+                for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                    keypos_t key      = {.col = col, .row = row};
+                    uint16_t keycode  = keymap_key_to_keycode(layer, key);
+                    uint16_t expected = action_for_keycode(keycode).code;
+                    uint16_t actual   = action_for_key(layer, key).code;
+                    if (actual != expected && mismatches++ < 10) {
+                        ADD_FAILURE() << "keycode 0x" << std::hex << keycode << ": table 0x" << actual << ", switch 0x" << expected;
+                    }
+                }
+            }
+        }
+    }
+    EXPECT_EQ(mismatches, 0);
+}
+
+TEST_F(ActionLookupTable, FollowsKeymapConfigChanges) {
+    keypos_t key = {.col = 0, .row = 0};
+    keycode_base = KC_LCTL;
+    action_lookup_table_clear();
+    EXPECT_EQ(action_for_key(0, key).code, ACTION_KEY(KC_LCTL));
+
+    keymap_config.swap_lctl_lgui = !keymap_config.swap_lctl_lgui;
+    EXPECT_EQ(action_for_key(0, key).code, action_for_keycode(KC_LCTL).code);
+    EXPECT_NE(action_for_key(0, key).code, ACTION_KEY(KC_LCTL));
+}
+
+TEST_F(ActionLookupTable, KeymapChangesNeedAClear) {
+    keypos_t key = {.col = 3, .row = 1};
+    keycode_base = KC_A;
+    action_lookup_table_clear();
+    action_t before = action_for_key(0, key);
+
+    keycode_base = KC_B;
+    EXPECT_EQ(action_for_key(0, key).code, before.code);
+    // layers past the table always go through the switch
+    EXPECT_EQ(action_for_key(ACTION_LOOKUP_TABLE_LAYERS, key).code, action_for_keycode(keymap_key_to_keycode(ACTION_LOOKUP_TABLE_LAYERS, key)).code);
+
+    action_lookup_table_clear();
+    EXPECT_EQ(action_for_key(0, key).code, action_for_keycode(keymap_key_to_keycode(0, key)).code);
+    EXPECT_NE(action_for_key(0, key).code, before.code);
+}
@@ -0,0 +1,111 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <vector>
+
+using testing::_;
+using testing::InSequence;
+using testing::InvokeWithoutArgs;
+
+namespace {
+struct ProcessedEvent {
+    uint16_t event_time;
+    uint16_t processed_time;
+};
+
+std::vector<ProcessedEvent> processed_events;
+}  // namespace
+
+extern "C" bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+    processed_events.push_back({record->event.time, timer_read()});
+    return true;
+}
+
+class BatchKeyEvents : public TestFixture {
+   protected:
+    // Presses the first `keys` keys of row 0 within one scan and releases them within a later one.
+    // Returns the total delay, in ms, between the matrix changes and the action pipeline seeing them.
+    uint32_t roll_latency(uint8_t keys);
+};
+
+uint32_t BatchKeyEvents::roll_latency(uint8_t keys) {
+    TestDriver driver;
+    unsigned   reports = 0;
+    uint32_t   latency = 0;
+
+    processed_events.clear();
+    EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(InvokeWithoutArgs([&reports]() { reports++; }));
+
+    for (uint8_t pressed = 0; pressed < 2; pressed++) {
+        uint16_t changed_at = timer_read();
+        for (uint8_t col = 0; col < keys; col++) {
+            if (pressed == 0) {
+                press_key(col, 0);
+            } else {
+                release_key(col, 0);
+            }
+        }
+        reports = 0;
+        idle_for(keys);
+        // one report per scan, however many keys changed
+        EXPECT_EQ(reports, 1);
+        for (auto& event : processed_events) {
+            EXPECT_EQ(event.event_time, changed_at | 1);
+            latency += event.processed_time - changed_at;
+        }
+        EXPECT_EQ(processed_events.size(), keys);
+        processed_events.clear();
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    return latency;
+}
+
+TEST_F(BatchKeyEvents, KeysChangedInOneScanAreSentInOneReport) {
+    TestDriver driver;
+    InSequence s;
+    press_key(0, 1);
+    press_key(0, 0);
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_A, KC_B)));
+    run_one_scan_loop();
+    release_key(0, 1);
+    release_key(0, 0);
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(BatchKeyEvents, KeyChangedInALaterScanGetsItsOwnReport) {
+    TestDriver driver;
+    InSequence s;
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    run_one_scan_loop();
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(BatchKeyEvents, TwoKeyRollAddsNoLatency) { EXPECT_EQ(roll_latency(2), 0); }
+
+TEST_F(BatchKeyEvents, SixKeyRollAddsNoLatency) { EXPECT_EQ(roll_latency(6), 0); }
+
+TEST_F(BatchKeyEvents, TenKeyRollAddsNoLatency) { EXPECT_EQ(roll_latency(10), 0); }
@@ -0,0 +1,110 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "test_simulator.hpp"
+
+extern "C" {
+#include "process_combo.h"
+}
+
+using testing::Matcher;
+
+namespace {
+// The first recorded report matching, or nullptr.
+const SimulatedReport* find_report(const TestSimulator& sim, Matcher<report_keyboard_t&> matcher) {
+    for (auto& recorded : sim.reports()) {
+        report_keyboard_t report = recorded.report;
+        if (matcher.Matches(report)) {
+            return &recorded;
+        }
+    }
+    return nullptr;
+}
+}  // namespace
+
+class Combo : public TestFixture {};
+
+TEST_F(Combo, ShorterComboWaitsForLongerOne) {
+    TestSimulator sim;
+    sim.replay(KeyTrace().down(0, 0, 0).down(10, 1, 0).up(200, 0, 0).up(210, 1, 0));
+
+    auto combo = find_report(sim, KeyboardReport(KC_ESC));
+    ASSERT_NE(combo, nullptr);
+    // C could still follow for A + B + C, so A + B is only sent after the combo term
+    EXPECT_GT(combo->latency, COMBO_TERM);
+    EXPECT_EQ(find_report(sim, KeyboardReport(KC_A)), nullptr);
+    EXPECT_EQ(find_report(sim, KeyboardReport(KC_B)), nullptr);
+}
+
+TEST_F(Combo, ShorterComboIsSentOnRelease) {
+    TestSimulator sim;
+    sim.replay(KeyTrace().down(0, 0, 0).down(10, 1, 0).up(20, 0, 0).up(25, 1, 0));
+
+    auto combo = find_report(sim, KeyboardReport(KC_ESC));
+    ASSERT_NE(combo, nullptr);
+    EXPECT_EQ(combo->latency, 20);
+}
+
+TEST_F(Combo, LongestComboWins) {
+    TestSimulator sim;
+    sim.replay(KeyTrace().down(0, 0, 0).down(10, 1, 0).down(20, 2, 0).up(100, 0, 0).up(100, 1, 0).up(100, 2, 0));
+
+    auto combo = find_report(sim, KeyboardReport(KC_TAB));
+    ASSERT_NE(combo, nullptr);
+    EXPECT_EQ(combo->latency, 20);
+    EXPECT_EQ(find_report(sim, KeyboardReport(KC_ESC)), nullptr);
+}
+
+TEST_F(Combo, OtherKeySettlesWaitingCombo) {
+    TestSimulator sim;
+    sim.replay(KeyTrace().down(0, 0, 0).down(10, 1, 0).tap(20, 5, 0, 10).up(100, 0, 0).up(100, 1, 0));
+
+    auto combo = find_report(sim, KeyboardReport(KC_ESC));
+    ASSERT_NE(combo, nullptr);
+    EXPECT_EQ(combo->latency, 20);
+    EXPECT_NE(find_report(sim, KeyboardReport(KC_ESC, KC_F)), nullptr);
+}
+
+TEST_F(Combo, PerComboTerm) {
+    TestSimulator sim;
+    // 150 ms apart: too slow for A + B, in time for D + E
+    sim.replay(KeyTrace().down(0, 0, 0).down(150, 1, 0).up(300, 0, 0).up(300, 1, 0));
+    EXPECT_EQ(find_report(sim, KeyboardReport(KC_ESC)), nullptr);
+    EXPECT_NE(find_report(sim, KeyboardReport(KC_A)), nullptr);
+
+    sim.clear();
+    sim.replay(KeyTrace().down(0, 3, 0).down(150, 4, 0).up(300, 3, 0).up(300, 4, 0));
+    EXPECT_NE(find_report(sim, KeyboardReport(KC_ENT)), nullptr);
+    EXPECT_EQ(find_report(sim, KeyboardReport(KC_D)), nullptr);
+}
+
+TEST_F(Combo, TwentyKeyCombo) {
+    TestSimulator sim;
+    KeyTrace      trace;
+    for (uint8_t key = 0; key < 20; key++) {
+        trace.down(key, key % 10, 1 + key / 10);
+    }
+    for (uint8_t key = 0; key < 20; key++) {
+        trace.up(100, key % 10, 1 + key / 10);
+    }
+    sim.replay(trace);
+
+    auto combo = find_report(sim, KeyboardReport(KC_SPC));
+    ASSERT_NE(combo, nullptr);
+    EXPECT_EQ(combo->latency, 19);
+    EXPECT_EQ(find_report(sim, KeyboardReport(KC_K)), nullptr);
+}
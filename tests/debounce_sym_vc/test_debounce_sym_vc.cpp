@@ -0,0 +1,132 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "matrix.h"
+#include "debounce.h"
+#include "timer.h"
+void advance_time(uint32_t ms);
+}
+
+class DebounceSymVc : public ::testing::Test {
+   public:
+    static void SetUpTestCase() { debounce_init(MATRIX_ROWS); }
+
+    DebounceSymVc() {
+        // Let anything left over from the previous test settle
+        scan(DEBOUNCE + 1);
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            raw[row] = 0;
+        }
+        scan(DEBOUNCE + 1);
+    }
+
+    // Scans once a millisecond for the given time, like a 1 kHz scan loop.
+    void scan(uint16_t ms) {
+        for (uint16_t i = 0; i < ms; i++) {
+            step();
+            advance_time(1);
+        }
+    }
+
+    void step() {
+        bool changed = memcmp(raw, last_raw, sizeof(raw)) != 0;
+        memcpy(last_raw, raw, sizeof(raw));
+        debounce(raw, cooked, MATRIX_ROWS, changed);
+    }
+
+    matrix_row_t raw[MATRIX_ROWS]      = {};
+    matrix_row_t last_raw[MATRIX_ROWS] = {};
+    matrix_row_t cooked[MATRIX_ROWS]   = {};
+};
+
+TEST_F(DebounceSymVc, ChangeIsPushedAfterDebounceMs) {
+    raw[1] = 1 << 3;
+    scan(DEBOUNCE);
+    EXPECT_EQ(cooked[1], 0);
+    scan(1);
+    EXPECT_EQ(cooked[1], 1 << 3);
+
+    raw[1] = 0;
+    scan(DEBOUNCE);
+    EXPECT_EQ(cooked[1], 1 << 3);
+    scan(1);
+    EXPECT_EQ(cooked[1], 0);
+}
+
+TEST_F(DebounceSymVc, BouncesRestartTheCount) {
+    raw[0] = 1;
+    scan(DEBOUNCE - 1);
+    raw[0] = 0;
+    scan(1);
+    raw[0] = 1;
+    scan(DEBOUNCE);
+    EXPECT_EQ(cooked[0], 0);
+    scan(1);
+    EXPECT_EQ(cooked[0], 1);
+}
+
+TEST_F(DebounceSymVc, ShortGlitchesAreIgnored) {
+    for (int i = 0; i < 20; i++) {
+        raw[2] = (i & 1) ? 0 : (1 << 9);
+        scan(2);
+    }
+    raw[2] = 0;
+    scan(DEBOUNCE + 1);
+    EXPECT_EQ(cooked[2], 0);
+}
+
+TEST_F(DebounceSymVc, KeysInARowCountIndependently) {
+    raw[3] = 1 << 0;
+    scan(2);
+    raw[3] |= 1 << 5;
+    scan(DEBOUNCE - 1);
+    EXPECT_EQ(cooked[3], 1 << 0);
+    scan(2);
+    EXPECT_EQ(cooked[3], (1 << 0) | (1 << 5));
+}
+
+TEST_F(DebounceSymVc, WholeMatrixAtOnce) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        raw[row] = (1 << MATRIX_COLS) - 1;
+    }
+    scan(DEBOUNCE + 1);
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        EXPECT_EQ(cooked[row], (1 << MATRIX_COLS) - 1);
+    }
+}
+
+TEST_F(DebounceSymVc, FasterScansCountTime) {
+    raw[0] = 1;
+    for (int i = 0; i < 4 * DEBOUNCE; i++) {
+        step();
+        step();
+        step();
+        step();
+        EXPECT_EQ(cooked[0], i >= DEBOUNCE ? 1 : 0);
+        advance_time(1);
+    }
+}
+
+TEST_F(DebounceSymVc, SlowScansCountTime) {
+    raw[0] = 1;
+    step();
+    advance_time(3 * DEBOUNCE);
+    step();
+    EXPECT_EQ(cooked[0], 1);
+}
@@ -0,0 +1,109 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "eeprom.h"
+#include "eeconfig.h"
+}
+
+// The parenthesised calls skip the cache macros and read what the driver holds
+#define driver_read_byte(addr) (eeprom_read_byte)((const uint8_t *)(addr))
+#define driver_read_dword(addr) (eeprom_read_dword)((const uint32_t *)(addr))
+
+using testing::_;
+using testing::AnyNumber;
+
+class EepromCache : public TestFixture {
+   public:
+    EepromCache() {
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        eeprom_cache_flush();
+    }
+
+    TestDriver driver;
+};
+
+TEST_F(EepromCache, WritesAreCommittedOnceIdle) {
+    eeconfig_update_user(0x12345678);
+    EXPECT_EQ(eeconfig_read_user(), 0x12345678);
+    EXPECT_NE(driver_read_dword(EECONFIG_USER), 0x12345678);
+    EXPECT_TRUE(eeprom_cache_is_dirty());
+
+    idle_for(EEPROM_CACHE_COMMIT_DELAY);
+    EXPECT_NE(driver_read_dword(EECONFIG_USER), 0x12345678);
+
+    idle_for(1);
+    EXPECT_EQ(driver_read_dword(EECONFIG_USER), 0x12345678);
+    EXPECT_FALSE(eeprom_cache_is_dirty());
+}
+
+TEST_F(EepromCache, EveryWriteRestartsTheDelay) {
+    for (uint8_t value = 1; value <= 10; value++) {
+        eeprom_update_byte(EECONFIG_VELOCIKEY, value);
+        idle_for(EEPROM_CACHE_COMMIT_DELAY / 2);
+    }
+    EXPECT_TRUE(eeprom_cache_is_dirty());
+    EXPECT_NE(driver_read_byte(EECONFIG_VELOCIKEY), 10);
+
+    idle_for(EEPROM_CACHE_COMMIT_DELAY);
+    EXPECT_EQ(driver_read_byte(EECONFIG_VELOCIKEY), 10);
+}
+
+TEST_F(EepromCache, UnchangedWritesDoNotDirtyTheCache) {
+    uint8_t value = eeprom_read_byte(EECONFIG_STENOMODE);
+    eeprom_update_byte(EECONFIG_STENOMODE, value);
+    eeprom_write_byte(EECONFIG_STENOMODE, value);
+    EXPECT_FALSE(eeprom_cache_is_dirty());
+}
+
+TEST_F(EepromCache, FlushCommitsImmediately) {
+    eeprom_update_byte(EECONFIG_UNICODEMODE, 0x5A);
+    eeprom_update_byte(EECONFIG_HANDEDNESS, 0xA5);
+    eeprom_cache_flush();
+    EXPECT_EQ(driver_read_byte(EECONFIG_UNICODEMODE), 0x5A);
+    EXPECT_EQ(driver_read_byte(EECONFIG_HANDEDNESS), 0xA5);
+    EXPECT_FALSE(eeprom_cache_is_dirty());
+}
+
+TEST_F(EepromCache, AccessesPastTheCacheGoToTheDriver) {
+    uint8_t* addr = (uint8_t*)512;
+    eeprom_update_byte(addr, 0x42);
+    EXPECT_EQ(driver_read_byte(addr), 0x42);
+    EXPECT_FALSE(eeprom_cache_is_dirty());
+
+    (eeprom_update_byte)(addr, 0x24);
+    EXPECT_EQ(eeprom_read_byte(addr), 0x24);
+}
+
+TEST_F(EepromCache, BlocksCanStraddleTheEndOfTheCache) {
+    const uint8_t data[4] = {1, 2, 3, 4};
+    uint8_t*      addr    = (uint8_t*)(EECONFIG_SIZE - 2);
+    eeprom_update_block(data, addr, sizeof(data));
+
+    EXPECT_NE(driver_read_byte(addr), 1);
+    EXPECT_EQ(driver_read_byte(addr + 2), 3);
+    EXPECT_EQ(driver_read_byte(addr + 3), 4);
+
+    uint8_t read[4] = {0};
+    eeprom_read_block(read, addr, sizeof(read));
+    EXPECT_EQ(memcmp(data, read, sizeof(data)), 0);
+
+    eeprom_cache_flush();
+    EXPECT_EQ(driver_read_byte(addr), 1);
+    EXPECT_EQ(driver_read_byte(addr + 1), 2);
+}
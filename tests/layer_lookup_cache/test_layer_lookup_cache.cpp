@@ -0,0 +1,112 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "dynamic_keymap.h"
+#include "eeconfig.h"
+#include "eeprom.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+class LayerLookupCache : public TestFixture {
+   public:
+    LayerLookupCache() {
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        dynamic_keymap_reset();
+        default_layer_set(1UL << 0);
+        layer_clear();
+    }
+
+    uint8_t layer_of(uint8_t col) { return layer_switch_get_layer((keypos_t){.col = col, .row = 0}); }
+
+    // Changes the keymap in EEPROM without going through dynamic_keymap_set_keycode()
+    void write_behind_cache(uint8_t layer, uint8_t col, uint16_t keycode) {
+        uint8_t *address = (uint8_t *)dynamic_keymap_key_to_eeprom_address(layer, 0, col);
+        eeprom_update_byte(address, keycode >> 8);
+        eeprom_update_byte(address + 1, keycode & 0xFF);
+    }
+
+    TestDriver driver;
+};
+
+TEST_F(LayerLookupCache, RepeatedLookupsHitTheCache) {
+    layer_on(1);
+    EXPECT_EQ(layer_of(0), 0);
+
+    // Still the cached answer, the keymap wasn't read again
+    write_behind_cache(1, 0, KC_Z);
+    EXPECT_EQ(layer_of(0), 0);
+
+    layer_lookup_cache_clear();
+    EXPECT_EQ(layer_of(0), 1);
+}
+
+TEST_F(LayerLookupCache, LayerStateChangesInvalidate) {
+    EXPECT_EQ(layer_of(1), 0);
+    EXPECT_EQ(layer_of(2), 0);
+
+    layer_on(1);
+    EXPECT_EQ(layer_of(1), 1);
+    EXPECT_EQ(layer_of(2), 0);
+
+    layer_on(2);
+    EXPECT_EQ(layer_of(1), 1);
+    EXPECT_EQ(layer_of(2), 2);
+
+    layer_off(1);
+    EXPECT_EQ(layer_of(1), 0);
+    EXPECT_EQ(layer_of(2), 2);
+
+    layer_state_set(0);
+    EXPECT_EQ(layer_of(1), 0);
+    EXPECT_EQ(layer_of(2), 0);
+}
+
+TEST_F(LayerLookupCache, DefaultLayerStateChangesInvalidate) {
+    EXPECT_EQ(layer_of(1), 0);
+
+    default_layer_set(1UL << 1);
+    EXPECT_EQ(layer_of(1), 1);
+
+    default_layer_set(1UL << 0);
+    EXPECT_EQ(layer_of(1), 0);
+}
+
+TEST_F(LayerLookupCache, DynamicKeymapWritesInvalidate) {
+    layer_on(1);
+    EXPECT_EQ(layer_of(0), 0);
+
+    dynamic_keymap_set_keycode(1, 0, 0, KC_Z);
+    EXPECT_EQ(layer_of(0), 1);
+
+    uint8_t  transparent[2] = {KC_TRNS >> 8, KC_TRNS & 0xFF};
+    uint16_t offset         = (uint8_t *)dynamic_keymap_key_to_eeprom_address(1, 0, 0) - (uint8_t *)dynamic_keymap_key_to_eeprom_address(0, 0, 0);
+    dynamic_keymap_set_buffer(offset, sizeof(transparent), transparent);
+    EXPECT_EQ(layer_of(0), 0);
+}
+
+TEST_F(LayerLookupCache, EeconfigInitInvalidates) {
+    default_layer_set(1UL << 1);
+    EXPECT_EQ(layer_of(1), 1);
+
+    eeconfig_init();
+    EXPECT_EQ(default_layer_state, 0);
+    EXPECT_EQ(layer_of(1), 0);
+}
@@ -0,0 +1,175 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "suspend.h"
+#include "timer.h"
+void     advance_time(uint32_t ms);
+extern uint16_t last_press_time;
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+#define SLEEP_MS 15
+
+static unsigned sleeps;
+static bool     can_sleep;
+static bool     wake_key;
+
+// Stands in for the platform: every sleep lasts one watchdog period
+extern "C" bool suspend_idle_sleep(void) {
+    if (!can_sleep) {
+        return false;
+    }
+    sleeps++;
+    advance_time(SLEEP_MS);
+    return true;
+}
+
+// What the armed matrix sees; the debounced matrix follows later
+extern "C" bool matrix_wake_check(void) { return wake_key; }
+
+class MatrixIdle : public TestFixture {
+   public:
+    MatrixIdle() {
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        can_sleep = true;
+        wake_key  = false;
+        // start every test with a fresh idle timeout
+        press_key(0, 0);
+        run_one_scan_loop();
+        release_key(0, 0);
+        run_one_scan_loop();
+        sleeps = 0;
+    }
+
+    ~MatrixIdle() { can_sleep = false; }
+
+    TestDriver driver;
+};
+
+TEST_F(MatrixIdle, SleepsOnlyAfterTheTimeout) {
+    idle_for(MATRIX_IDLE_TIMEOUT - 2);
+    EXPECT_EQ(sleeps, 0);
+
+    idle_for(2);
+    EXPECT_EQ(sleeps, 1);
+
+    idle_for(10);
+    EXPECT_EQ(sleeps, 11);
+}
+
+TEST_F(MatrixIdle, HeldKeyKeepsTheMatrixAwake) {
+    press_key(1, 0);
+    idle_for(MATRIX_IDLE_TIMEOUT * 2);
+    EXPECT_EQ(sleeps, 0);
+
+    release_key(1, 0);
+    idle_for(MATRIX_IDLE_TIMEOUT + 1);
+    EXPECT_EQ(sleeps, 1);
+}
+
+TEST_F(MatrixIdle, KeypressWakesTheScan) {
+    idle_for(MATRIX_IDLE_TIMEOUT + 5);
+    ASSERT_GT(sleeps, 0);
+
+    wake_key = true;
+    press_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    unsigned before = sleeps;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    wake_key = false;
+    release_key(2, 0);
+    idle_for(MATRIX_IDLE_TIMEOUT - 1);
+    EXPECT_EQ(sleeps, before);
+}
+
+TEST_F(MatrixIdle, FirstEventIsDatedToTheWakeUp) {
+    idle_for(MATRIX_IDLE_TIMEOUT + 5);
+
+    // the key is sensed on wake-up, but only debounced a few scans later
+    wake_key           = true;
+    uint16_t wake_time = (timer_read() + SLEEP_MS) | 1;
+    run_one_scan_loop();
+    idle_for(5);
+    press_key(3, 0);
+    run_one_scan_loop();
+
+    EXPECT_EQ(last_press_time, wake_time);
+    wake_key = false;
+    release_key(3, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(MatrixIdle, StaleWakeUpIsNotUsed) {
+    idle_for(MATRIX_IDLE_TIMEOUT + 5);
+
+    // a wake-up that never turned into a key event
+    wake_key = true;
+    run_one_scan_loop();
+    wake_key = false;
+    idle_for(MATRIX_IDLE_WAKE_WINDOW);
+    press_key(4, 0);
+    uint16_t press_time = timer_read() | 1;
+    run_one_scan_loop();
+
+    EXPECT_EQ(last_press_time, press_time);
+    release_key(4, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(MatrixIdle, RetriesAfterAnotherTimeoutWhenSleepIsUnavailable) {
+    can_sleep = false;
+    idle_for(MATRIX_IDLE_TIMEOUT + 10);
+    can_sleep = true;
+    idle_for(MATRIX_IDLE_TIMEOUT - 20);
+    EXPECT_EQ(sleeps, 0);
+
+    idle_for(20);
+    EXPECT_GT(sleeps, 0);
+}
+
+TEST_F(MatrixIdle, MouseReportEndsTheIdlePeriod) {
+    idle_for(MATRIX_IDLE_TIMEOUT + 5);
+    ASSERT_GT(sleeps, 0);
+
+    report_mouse_t report = {};
+    report.x              = 1;
+    EXPECT_CALL(driver, send_mouse_mock(_));
+    host_mouse_send(&report);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    unsigned before = sleeps;
+    idle_for(MATRIX_IDLE_TIMEOUT - 1);
+    EXPECT_EQ(sleeps, before);
+}
+
+TEST_F(MatrixIdle, EncoderActivityEndsTheIdlePeriod) {
+    idle_for(MATRIX_IDLE_TIMEOUT + 5);
+    ASSERT_GT(sleeps, 0);
+
+    matrix_idle_activity();
+    unsigned before = sleeps;
+    idle_for(MATRIX_IDLE_TIMEOUT - 1);
+    EXPECT_EQ(sleeps, before);
+}
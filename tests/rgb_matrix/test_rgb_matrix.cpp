@@ -0,0 +1,87 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <vector>
+
+using testing::_;
+using testing::AnyNumber;
+
+extern "C" {
+#include "rgb_matrix.h"
+extern bool indicator_on;
+}
+
+static std::vector<std::vector<LED_TYPE>> frames;
+
+extern "C" void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds) { frames.push_back(std::vector<LED_TYPE>(ledarray, ledarray + number_of_leds)); }
+
+static bool same_color(LED_TYPE a, RGB b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
+
+class RgbMatrix : public TestFixture {
+   public:
+    RgbMatrix() {
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        indicator_on = false;
+        rgb_matrix_enable_noeeprom();
+        rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+        rgb_matrix_sethsv_noeeprom(0, 0, 100);
+        // let the effect settle
+        idle_for(100);
+        frames.clear();
+    }
+
+    void expect_solid(const std::vector<LED_TYPE> &frame, HSV hsv) {
+        ASSERT_EQ(frame.size(), DRIVER_LED_TOTAL);
+        for (auto led : frame) {
+            EXPECT_TRUE(same_color(led, hsv_to_rgb(hsv)));
+        }
+    }
+
+    TestDriver driver;
+};
+
+TEST_F(RgbMatrix, StaticEffectIsNotRedrawnWhenUnchanged) {
+    idle_for(200);
+    EXPECT_TRUE(frames.empty());
+}
+
+TEST_F(RgbMatrix, ConfigChangeRedrawsTheEffect) {
+    rgb_matrix_sethsv_noeeprom(85, 255, 200);
+    idle_for(50);
+    ASSERT_EQ(frames.size(), 1);
+    expect_solid(frames[0], {85, 255, 200});
+
+    idle_for(100);
+    EXPECT_EQ(frames.size(), 1);
+}
+
+TEST_F(RgbMatrix, EffectIsRedrawnOnceAnOverlayStops) {
+    indicator_on = true;
+    idle_for(50);
+    ASSERT_FALSE(frames.empty());
+    EXPECT_EQ(frames.back()[0].r, 255);
+    EXPECT_EQ(frames.back()[0].g, 0);
+
+    indicator_on = false;
+    frames.clear();
+    idle_for(50);
+    ASSERT_EQ(frames.size(), 1);
+    expect_solid(frames[0], {0, 0, 100});
+
+    idle_for(100);
+    EXPECT_EQ(frames.size(), 1);
+}
@@ -0,0 +1,169 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <vector>
+
+extern "C" {
+#include "rgblight.h"
+#include "led_tables.h"
+}
+
+static std::vector<std::vector<LED_TYPE>> frames;
+
+extern "C" void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds) { frames.push_back(std::vector<LED_TYPE>(ledarray, ledarray + number_of_leds)); }
+
+// hsv_to_rgb() as it was before the fixed-point rewrite
+static RGB reference_hsv_to_rgb(HSV hsv) {
+    RGB      rgb;
+    uint8_t  region, remainder, p, q, t;
+    uint16_t h, s, v;
+
+    if (hsv.s == 0) {
+        rgb.r = rgb.g = rgb.b = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
+        return rgb;
+    }
+
+    h = hsv.h;
+    s = hsv.s;
+    v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
+
+    region    = h * 6 / 255;
+    remainder = (h * 2 - region * 85) * 3;
+
+    p = (v * (255 - s)) >> 8;
+    q = (v * (255 - ((s * remainder) >> 8))) >> 8;
+    t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+
+    switch (region) {
+        case 6:
+        case 0:
+            rgb.r = v, rgb.g = t, rgb.b = p;
+            break;
+        case 1:
+            rgb.r = q, rgb.g = v, rgb.b = p;
+            break;
+        case 2:
+            rgb.r = p, rgb.g = v, rgb.b = t;
+            break;
+        case 3:
+            rgb.r = p, rgb.g = q, rgb.b = v;
+            break;
+        case 4:
+            rgb.r = t, rgb.g = p, rgb.b = v;
+            break;
+        default:
+            rgb.r = v, rgb.g = p, rgb.b = q;
+            break;
+    }
+    return rgb;
+}
+
+static bool same_color(LED_TYPE a, LED_TYPE b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
+
+class Rgblight : public TestFixture {
+   public:
+    Rgblight() {
+        rgblight_init();
+        rgblight_enable_noeeprom();
+        rgblight_mode_noeeprom(RGBLIGHT_MODE_STATIC_LIGHT);
+        rgblight_set_clipping_range(0, RGBLED_NUM);
+        rgblight_set_effect_range(0, RGBLED_NUM);
+        rgblight_setrgb(0, 0, 0);
+        frames.clear();
+    }
+};
+
+TEST_F(Rgblight, HsvToRgbMatchesTheReference) {
+    unsigned mismatches = 0;
+
+    for (uint32_t i = 0; i < 0x1000000; i++) {
+        HSV hsv      = {(uint8_t)(i >> 16), (uint8_t)(i >> 8), (uint8_t)i};
+        RGB actual   = hsv_to_rgb(hsv);
+        RGB expected = reference_hsv_to_rgb(hsv);
+        if (!same_color(actual, expected) && mismatches++ < 10) {
+            ADD_FAILURE() << "hsv " << (int)hsv.h << "," << (int)hsv.s << "," << (int)hsv.v;
+        }
+    }
+    EXPECT_EQ(mismatches, 0);
+}
+
+TEST_F(Rgblight, HsvToRgbRampMatchesHsvToRgb) {
+    LED_TYPE leds[256];
+
+    for (uint8_t step : {1, 3, 31, 255}) {
+        for (uint8_t sat : {0, 1, 128, 255}) {
+            HSV hsv = {200, sat, 180};
+            hsv_to_rgb_ramp(hsv, step, leds, 255);
+            for (uint8_t i = 0; i < 255; i++) {
+                HSV expected = {(uint8_t)(hsv.h + i * step), sat, hsv.v};
+                EXPECT_TRUE(same_color(leds[i], hsv_to_rgb(expected))) << "step " << (int)step << ", sat " << (int)sat << ", led " << (int)i;
+            }
+        }
+    }
+}
+
+TEST_F(Rgblight, UnchangedFramesAreNotSent) {
+    rgblight_set();
+    EXPECT_TRUE(frames.empty());
+
+    rgblight_setrgb(0, 0, 0);
+    EXPECT_TRUE(frames.empty());
+
+    rgblight_setrgb(1, 2, 3);
+    ASSERT_EQ(frames.size(), 1);
+    EXPECT_EQ(frames[0].size(), RGBLED_NUM);
+}
+
+TEST_F(Rgblight, SendsTheWholeFrameInChainOrder) {
+    // the LED map reverses the chain, so the last LED is the first one sent
+    rgblight_setrgb_at(10, 20, 30, RGBLED_NUM - 1);
+    ASSERT_EQ(frames.size(), 1);
+    ASSERT_EQ(frames[0].size(), RGBLED_NUM);
+    EXPECT_EQ(frames[0][0].r, 10);
+    EXPECT_EQ(frames[0][0].g, 20);
+    EXPECT_EQ(frames[0][0].b, 30);
+
+    // a change at the start of led[] still sends the whole chain
+    rgblight_setrgb_at(40, 50, 60, 0);
+    ASSERT_EQ(frames.size(), 2);
+    ASSERT_EQ(frames[1].size(), RGBLED_NUM);
+    EXPECT_EQ(frames[1][0].r, 10);
+    EXPECT_EQ(frames[1][RGBLED_NUM - 1].r, 40);
+}
+
+TEST_F(Rgblight, ClippingRangeChangeResendsTheFrame) {
+    rgblight_set_clipping_range(2, 4);
+    rgblight_set();
+    ASSERT_EQ(frames.size(), 1);
+    EXPECT_EQ(frames[0].size(), 4);
+
+    rgblight_set();
+    EXPECT_EQ(frames.size(), 1);
+}
+
+TEST_F(Rgblight, RainbowSwirlMatchesSethsv) {
+    animation_status_t anim = {};
+    anim.current_hue        = 100;
+
+    rgblight_sethsv_noeeprom(0, 200, 150);
+    rgblight_effect_rainbow_swirl(&anim);
+    for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+        LED_TYPE expected;
+        sethsv(100 + 255 / RGBLED_NUM * i, 200, 150, &expected);
+        EXPECT_TRUE(same_color(led[i], expected)) << "led " << (int)i;
+    }
+}
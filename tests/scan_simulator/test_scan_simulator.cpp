@@ -0,0 +1,152 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "test_simulator.hpp"
+#include <string>
+
+extern "C" {
+#include "action_tapping.h"
+#include "process_auto_shift.h"
+#include "process_combo.h"
+}
+
+using testing::Matcher;
+
+namespace {
+// Traces live next to this file; tests run from the repository root.
+std::string trace_path(const char* name) {
+    std::string file = __FILE__;
+    return file.substr(0, file.rfind('/')) + "/traces/" + name;
+}
+
+// The first recorded report matching, or nullptr.
+const SimulatedReport* find_report(const TestSimulator& sim, Matcher<report_keyboard_t&> matcher) {
+    for (auto& recorded : sim.reports()) {
+        report_keyboard_t report = recorded.report;
+        if (matcher.Matches(report)) {
+            return &recorded;
+        }
+    }
+    return nullptr;
+}
+}  // namespace
+
+class ScanSimulator : public TestFixture {
+   protected:
+    void SetUp() override { autoshift_disable(); }
+    void TearDown() override { autoshift_disable(); }
+};
+
+TEST_F(ScanSimulator, ParsesTraceText) {
+    KeyTrace trace = KeyTrace::from_string(
+        "# comment\n"
+        "0 down 1 2\n"
+        "\n"
+        "15 up 1 2  # trailing comment\n");
+    ASSERT_EQ(trace.events().size(), 2);
+    EXPECT_EQ(trace.events()[0].time, 0);
+    EXPECT_EQ(trace.events()[0].col, 1);
+    EXPECT_EQ(trace.events()[0].row, 2);
+    EXPECT_TRUE(trace.events()[0].pressed);
+    EXPECT_EQ(trace.events()[1].time, 15);
+    EXPECT_FALSE(trace.events()[1].pressed);
+    EXPECT_EQ(trace.duration(), 15);
+}
+
+TEST_F(ScanSimulator, PlainTypingAddsNoLatency) {
+    TestSimulator sim;
+    sim.replay(KeyTrace::from_file(trace_path("typing.trace")));
+    sim.print_latency("typing");
+
+    LatencyStats stats = sim.latency_stats();
+    // one report per key change
+    EXPECT_EQ(stats.reports, 14);
+    EXPECT_EQ(stats.max, 0);
+}
+
+TEST_F(ScanSimulator, ModTapTapIsSentOnRelease) {
+    TestSimulator sim;
+    sim.replay(KeyTrace().tap(0, 4, 0, 80));
+
+    auto tap = find_report(sim, KeyboardReport(KC_E));
+    ASSERT_NE(tap, nullptr);
+    EXPECT_EQ(tap->latency, 80);
+}
+
+TEST_F(ScanSimulator, ModTapHoldIsSentWithinTappingTerm) {
+    TestSimulator sim;
+    sim.replay(KeyTrace().tap(0, 4, 0, 300));
+
+    auto hold = find_report(sim, KeyboardReport(KC_LSFT));
+    ASSERT_NE(hold, nullptr);
+    EXPECT_LE(hold->latency, TAPPING_TERM);
+    EXPECT_GE(hold->latency, TAPPING_TERM - 1);
+}
+
+TEST_F(ScanSimulator, ModTapTrace) {
+    TestSimulator sim;
+    sim.replay(KeyTrace::from_file(trace_path("mod_tap.trace")));
+    sim.print_latency("mod tap");
+
+    EXPECT_LE(sim.latency_stats().max, TAPPING_TERM);
+}
+
+TEST_F(ScanSimulator, ComboIsSentWhenComplete) {
+    TestSimulator sim;
+    sim.replay(KeyTrace::from_file(trace_path("combo.trace")));
+    sim.print_latency("combo");
+
+    auto combo = find_report(sim, KeyboardReport(KC_TAB));
+    ASSERT_NE(combo, nullptr);
+    // from the first key of the combo to the second
+    EXPECT_EQ(combo->latency, 20);
+
+    // a lone combo key waits for the combo term
+    auto single = find_report(sim, KeyboardReport(KC_I));
+    ASSERT_NE(single, nullptr);
+    EXPECT_GT(single->latency, COMBO_TERM);
+    EXPECT_LE(single->latency, COMBO_TERM + 1);
+}
+
+TEST_F(ScanSimulator, TapDanceResolvesAfterTappingTerm) {
+    TestSimulator sim;
+    sim.replay(KeyTrace::from_file(trace_path("tap_dance.trace")));
+    sim.print_latency("tap dance");
+
+    auto single = find_report(sim, KeyboardReport(KC_G));
+    ASSERT_NE(single, nullptr);
+    EXPECT_GE(single->latency, TAPPING_TERM);
+    EXPECT_LE(single->latency, TAPPING_TERM + 1);
+
+    // the second tap completes the dance without waiting
+    auto doubled = find_report(sim, KeyboardReport(KC_ESC));
+    ASSERT_NE(doubled, nullptr);
+    EXPECT_LT(doubled->latency, TAPPING_TERM);
+}
+
+TEST_F(ScanSimulator, AutoShiftSendsOnRelease) {
+    autoshift_enable();
+    TestSimulator sim;
+    sim.replay(KeyTrace::from_file(trace_path("typing.trace")));
+    sim.print_latency("auto shift typing");
+
+    // each key is sent once it is released, or when the next one is pressed
+    LatencyStats stats = sim.latency_stats();
+    EXPECT_GT(stats.max, 0);
+    EXPECT_LT(stats.max, AUTO_SHIFT_TIMEOUT);
+    EXPECT_NE(find_report(sim, KeyboardReport(KC_A)), nullptr);
+}
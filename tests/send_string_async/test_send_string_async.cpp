@@ -0,0 +1,167 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+static uint8_t queue_free;
+
+// Stands in for the report queue of the USB driver
+extern "C" uint8_t host_keyboard_queue_free(void) { return queue_free; }
+
+class SendStringAsync : public TestFixture {
+   public:
+    SendStringAsync() { queue_free = UINT8_MAX; }
+
+    // Runs one scan and checks the reports it was expected to send
+    void scan() {
+        run_one_scan_loop();
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+
+    TestDriver driver;
+};
+
+TEST_F(SendStringAsync, SendsAFewReportsPerScan) {
+    EXPECT_TRUE(send_string_async("Hi"));
+    EXPECT_TRUE(send_string_async_busy());
+
+    {
+        InSequence s;
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_H)));
+    }
+    scan();
+    {
+        InSequence s;
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    }
+    scan();
+    {
+        InSequence s;
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_I)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    }
+    scan();
+
+    EXPECT_FALSE(send_string_async_busy());
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    scan();
+}
+
+TEST_F(SendStringAsync, WaitsForRoomInTheReportQueue) {
+    EXPECT_TRUE(send_string_async("a"));
+
+    queue_free = 0;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    scan();
+    scan();
+    EXPECT_TRUE(send_string_async_busy());
+
+    // the press takes the last free slot, the release has to wait
+    queue_free = 1;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).WillOnce(testing::InvokeWithoutArgs([] { queue_free--; }));
+    scan();
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    scan();
+
+    queue_free = UINT8_MAX;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    scan();
+    EXPECT_FALSE(send_string_async_busy());
+}
+
+TEST_F(SendStringAsync, DelaysDoNotBlockTheScan) {
+    uint32_t start = timer_read32();
+    EXPECT_TRUE(send_string_async("a" SS_DELAY(50) "b"));
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(2);
+    scan();
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    while (timer_elapsed32(start) < 50) {
+        scan();
+    }
+    EXPECT_TRUE(send_string_async_busy());
+
+    {
+        InSequence s;
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    }
+    scan();
+    EXPECT_FALSE(send_string_async_busy());
+}
+
+TEST_F(SendStringAsync, IntervalFollowsEveryCharacter) {
+    EXPECT_TRUE(send_string_with_delay_async("ab", 10));
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(2);
+    scan();
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    for (int i = 0; i < 9; i++) {
+        scan();
+    }
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(2);
+    scan();
+    EXPECT_TRUE(send_string_async_busy());
+    idle_for(10);
+    EXPECT_FALSE(send_string_async_busy());
+}
+
+TEST_F(SendStringAsync, StringsThatDoNotFitAreNotQueued) {
+    for (int i = 0; i < SEND_STRING_ASYNC_QUEUE_SIZE - 1; i++) {
+        EXPECT_TRUE(send_char_async('a'));
+    }
+    EXPECT_EQ(send_string_async_free(), 1);
+    EXPECT_FALSE(send_string_async("ab"));
+    EXPECT_FALSE(wait_ms_async(300));
+    EXPECT_EQ(send_string_async_free(), 1);
+    EXPECT_TRUE(send_string_async("a"));
+    EXPECT_EQ(send_string_async_free(), 0);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(SEND_STRING_ASYNC_QUEUE_SIZE * 2);
+    idle_for(SEND_STRING_ASYNC_QUEUE_SIZE);
+    EXPECT_FALSE(send_string_async_busy());
+}
+
+TEST_F(SendStringAsync, CancelReleasesHeldKeys) {
+    EXPECT_TRUE(register_code_async(KC_LCTL));
+    EXPECT_TRUE(tap_code_async(KC_C));
+    EXPECT_TRUE(unregister_code_async(KC_LCTL));
+    EXPECT_TRUE(tap_code_async(KC_V));
+
+    {
+        InSequence s;
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_C)));
+    }
+    scan();
+
+    {
+        InSequence s;
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    }
+    send_string_async_cancel();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_FALSE(send_string_async_busy());
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    scan();
+}
@@ -0,0 +1,132 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include "source_layers_cache.h"
+}
+
+namespace {
+struct Board {
+    const char* name;
+    uint16_t    keys;
+};
+
+// 5x15, 6x17 and 6x22 matrices
+const Board boards[] = {{"60%", 75}, {"TKL", 102}, {"full-size", 132}};
+
+struct Layout {
+    const char* name;
+    uint8_t     layer_bits;
+    size_t (*size)(uint16_t keys, uint8_t layer_bits);
+    void (*write)(uint8_t* cache, uint8_t layer_bits, uint16_t key_number, uint8_t layer);
+    uint8_t (*read)(const uint8_t* cache, uint8_t layer_bits, uint16_t key_number);
+};
+
+const Layout layouts[] = {
+    {"bit-plane, 32 layers", 5, [](uint16_t keys, uint8_t layer_bits) -> size_t { return SOURCE_LAYERS_CACHE_BITPLANE_SIZE(keys, layer_bits); }, source_layers_cache_bitplane_write, source_layers_cache_bitplane_read},
+    {"bit-plane, 16 layers", 4, [](uint16_t keys, uint8_t layer_bits) -> size_t { return SOURCE_LAYERS_CACHE_BITPLANE_SIZE(keys, layer_bits); }, source_layers_cache_bitplane_write, source_layers_cache_bitplane_read},
+    {"nibble", 4, [](uint16_t keys, uint8_t) -> size_t { return SOURCE_LAYERS_CACHE_NIBBLE_SIZE(keys); }, [](uint8_t* cache, uint8_t, uint16_t key_number, uint8_t layer) { source_layers_cache_nibble_write(cache, key_number, layer); },
+     [](const uint8_t* cache, uint8_t, uint16_t key_number) { return source_layers_cache_nibble_read(cache, key_number); }},
+    {"byte", 5, [](uint16_t keys, uint8_t) -> size_t { return SOURCE_LAYERS_CACHE_BYTE_SIZE(keys); }, [](uint8_t* cache, uint8_t, uint16_t key_number, uint8_t layer) { source_layers_cache_byte_write(cache, key_number, layer); },
+     [](const uint8_t* cache, uint8_t, uint16_t key_number) { return source_layers_cache_byte_read(cache, key_number); }},
+};
+
+const unsigned benchmark_rounds = 2000;
+const unsigned benchmark_runs   = 5;
+
+// Best of several runs of host time per lookup, so that a preempted run doesn't count
+double lookup_ns(const Board& board, const Layout& layout) {
+    std::vector<uint8_t> cache(layout.size(board.keys, layout.layer_bits), 0);
+    volatile uint8_t     sink = 0;
+    double               best = 0;
+
+    for (uint16_t key = 0; key < board.keys; key++) {
+        layout.write(cache.data(), layout.layer_bits, key, key & ((1 << layout.layer_bits) - 1));
+    }
+    for (unsigned run = 0; run < benchmark_runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned round = 0; round < benchmark_rounds; round++) {
+            for (uint16_t key = 0; key < board.keys; key++) {
+                sink = sink + layout.read(cache.data(), layout.layer_bits, key);
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (benchmark_rounds * board.keys);
+        best         = run == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+}  // namespace
+
+class SourceLayersCache : public TestFixture {};
+
+TEST_F(SourceLayersCache, EveryLayoutKeepsEveryKeyIndependent) {
+    for (auto& board : boards) {
+        for (auto& layout : layouts) {
+            std::vector<uint8_t> cache(layout.size(board.keys, layout.layer_bits), 0);
+            uint8_t              layers = 1 << layout.layer_bits;
+            for (uint16_t key = 0; key < board.keys; key++) {
+                layout.write(cache.data(), layout.layer_bits, key, (key * 7) % layers);
+            }
+            for (uint16_t key = 0; key < board.keys; key++) {
+                EXPECT_EQ(layout.read(cache.data(), layout.layer_bits, key), (key * 7) % layers) << board.name << ", " << layout.name << ", key " << key;
+            }
+        }
+    }
+}
+
+TEST_F(SourceLayersCache, PackedLayoutsAreNoLargerThanBytesPerKey) {
+    for (auto& board : boards) {
+        for (auto& layout : layouts) {
+            EXPECT_LE(layout.size(board.keys, layout.layer_bits), SOURCE_LAYERS_CACHE_BYTE_SIZE(board.keys)) << board.name << ", " << layout.name;
+        }
+    }
+}
+
+// Prints RAM use and host time per lookup; nibbles and bytes must be cheaper to look up than 32 layers of bit-planes
+TEST_F(SourceLayersCache, PackedLayoutsLookUpFasterThanBitPlanes) {
+    const Layout& bitplane = layouts[0];
+    const Layout& nibble   = layouts[2];
+    const Layout& byte     = layouts[3];
+
+    for (auto& board : boards) {
+        std::vector<double> ns;
+        for (auto& layout : layouts) {
+            ns.push_back(lookup_ns(board, layout));
+            std::cout << "[ BENCH    ] " << board.name << " (" << board.keys << " keys), " << layout.name << ": " << layout.size(board.keys, layout.layer_bits) << " bytes, " << ns.back() << " ns per lookup" << std::endl;
+        }
+        EXPECT_LT(ns[&nibble - layouts], ns[&bitplane - layouts]) << board.name;
+        EXPECT_LT(ns[&byte - layouts], ns[&bitplane - layouts]) << board.name;
+    }
+}
+
+TEST_F(SourceLayersCache, ConfiguredLayoutRoundTrips) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            update_source_layers_cache((keypos_t){.col = col, .row = row}, (row * MATRIX_COLS + col) % 16);
+        }
+    }
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            EXPECT_EQ(read_source_layers_cache((keypos_t){.col = col, .row = row}), (row * MATRIX_COLS + col) % 16);
+        }
+    }
+}
@@ -0,0 +1,165 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_simulator.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "gtest/gtest.h"
+#include "test_matrix.h"
+
+extern "C" {
+#include "keyboard.h"
+#include "timer.h"
+void advance_time(uint32_t ms);
+}
+
+KeyTrace KeyTrace::parse(std::istream& input) {
+    KeyTrace    trace;
+    std::string line;
+    unsigned    line_number = 0;
+
+    while (std::getline(input, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream fields(line);
+        uint32_t           time;
+        std::string        action;
+        unsigned           col, row;
+        if (!(fields >> time)) {
+            continue;
+        }
+        if (!(fields >> action >> col >> row) || (action != "down" && action != "up")) {
+            ADD_FAILURE() << "bad trace line " << line_number << ": " << line;
+            break;
+        }
+        if (!trace.m_events.empty() && time < trace.m_events.back().time) {
+            ADD_FAILURE() << "trace line " << line_number << " goes back in time";
+            break;
+        }
+        trace.m_events.push_back({time, static_cast<uint8_t>(col), static_cast<uint8_t>(row), action == "down"});
+    }
+    return trace;
+}
+
+KeyTrace KeyTrace::from_string(const std::string& text) {
+    std::istringstream input(text);
+    return parse(input);
+}
+
+KeyTrace KeyTrace::from_file(const std::string& path) {
+    std::ifstream input(path);
+    if (!input) {
+        ADD_FAILURE() << "can't open trace " << path;
+    }
+    return parse(input);
+}
+
+KeyTrace& KeyTrace::down(uint32_t time, uint8_t col, uint8_t row) {
+    m_events.push_back({time, col, row, true});
+    return *this;
+}
+
+KeyTrace& KeyTrace::up(uint32_t time, uint8_t col, uint8_t row) {
+    m_events.push_back({time, col, row, false});
+    return *this;
+}
+
+KeyTrace& KeyTrace::tap(uint32_t time, uint8_t col, uint8_t row, uint32_t hold) { return down(time, col, row).up(time + hold, col, row); }
+
+TestSimulator* TestSimulator::m_this = nullptr;
+
+TestSimulator::TestSimulator() : m_driver{&TestSimulator::keyboard_leds, &TestSimulator::send_keyboard, &TestSimulator::send_mouse, &TestSimulator::send_system, &TestSimulator::send_consumer} {
+    host_set_driver(&m_driver);
+    m_this = this;
+}
+
+TestSimulator::~TestSimulator() {
+    host_set_driver(nullptr);
+    m_this = nullptr;
+}
+
+void TestSimulator::replay(const KeyTrace& trace, uint32_t settle_ms) {
+    const uint32_t start = timer_read32();
+    const uint32_t end   = trace.duration() + settle_ms;
+    auto           event = trace.events().begin();
+
+    for (uint32_t now = 0; now <= end; now++) {
+        for (; event != trace.events().end() && event->time <= now; ++event) {
+            if (event->pressed) {
+                press_key(event->col, event->row);
+            } else {
+                release_key(event->col, event->row);
+            }
+            m_pending.push_back(start + event->time);
+        }
+        keyboard_task();
+        advance_time(1);
+    }
+}
+
+LatencyStats TestSimulator::latency_stats() const {
+    LatencyStats stats = {m_reports.size(), 0, 0, 0.0, 0, 0};
+    if (m_reports.empty()) {
+        return stats;
+    }
+
+    std::vector<uint32_t> latencies;
+    for (auto& report : m_reports) {
+        latencies.push_back(report.latency);
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    uint64_t sum = 0;
+    for (auto latency : latencies) {
+        sum += latency;
+    }
+    stats.min  = latencies.front();
+    stats.max  = latencies.back();
+    stats.mean = static_cast<double>(sum) / latencies.size();
+    stats.p50  = latencies[(latencies.size() - 1) / 2];
+    stats.p99  = latencies[(latencies.size() - 1) * 99 / 100];
+    return stats;
+}
+
+void TestSimulator::print_latency(const char* name) const {
+    LatencyStats stats = latency_stats();
+    printf("%-24s %4zu reports  latency min %3u  p50 %3u  p99 %3u  max %3u  mean %6.1f ms\n", name, stats.reports, stats.min, stats.p50, stats.p99, stats.max, stats.mean);
+}
+
+void TestSimulator::clear() {
+    m_reports.clear();
+    m_pending.clear();
+}
+
+uint8_t TestSimulator::keyboard_leds(void) { return 0; }
+
+void TestSimulator::send_keyboard(report_keyboard_t* report) {
+    const uint32_t now = timer_read32();
+    if (!m_this->m_pending.empty()) {
+        m_this->m_last_cause = m_this->m_pending.front();
+        m_this->m_pending.clear();
+    }
+    m_this->m_reports.push_back({now, now - m_this->m_last_cause, *report});
+}
+
+void TestSimulator::send_mouse(report_mouse_t* report) {}
+
+void TestSimulator::send_system(uint16_t data) {}
+
+void TestSimulator::send_consumer(uint16_t data) {}
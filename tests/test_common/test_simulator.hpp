@@ -0,0 +1,106 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <istream>
+#include <string>
+#include <vector>
+#include "host.h"
+#include "report.h"
+
+// One physical key change, at a time relative to the start of the trace.
+struct TraceEvent {
+    uint32_t time;
+    uint8_t  col;
+    uint8_t  row;
+    bool     pressed;
+};
+
+// A scripted sequence of key changes.
+//
+// The text format has one event per line, `<ms> <down|up> <col> <row>`, with
+// the times counted from the start of the trace. Blank lines and everything
+// after a `#` are ignored. Events must be in time order; a malformed trace
+// fails the current test.
+class KeyTrace {
+public:
+    static KeyTrace parse(std::istream& input);
+    static KeyTrace from_string(const std::string& text);
+    static KeyTrace from_file(const std::string& path);
+
+    KeyTrace& down(uint32_t time, uint8_t col, uint8_t row);
+    KeyTrace& up(uint32_t time, uint8_t col, uint8_t row);
+    KeyTrace& tap(uint32_t time, uint8_t col, uint8_t row, uint32_t hold);
+
+    const std::vector<TraceEvent>& events() const { return m_events; }
+    uint32_t                       duration() const { return m_events.empty() ? 0 : m_events.back().time; }
+
+private:
+    std::vector<TraceEvent> m_events;
+};
+
+// A keyboard report produced during a replay. Latency is the time from the
+// oldest key change not yet reflected in a report to this report; reports
+// caused by a timer (tapping term, tap dance, ...) with no new key change
+// are measured from the change that caused the previous report.
+struct SimulatedReport {
+    uint32_t          time;
+    uint32_t          latency;
+    report_keyboard_t report;
+};
+
+struct LatencyStats {
+    size_t   reports;
+    uint32_t min;
+    uint32_t max;
+    double   mean;
+    uint32_t p50;
+    uint32_t p99;
+};
+
+// Drives keyboard_task() once per virtual millisecond while replaying a key
+// trace, and records every keyboard report with its latency. Everything runs
+// on the virtual clock, so results are the same on every run and can be
+// asserted on like any other test output.
+class TestSimulator {
+public:
+    TestSimulator();
+    ~TestSimulator();
+
+    // Replays the trace, then keeps scanning for settle_ms so that pending
+    // timers (tapping term, combo term, ...) can fire.
+    void replay(const KeyTrace& trace, uint32_t settle_ms = 500);
+
+    const std::vector<SimulatedReport>& reports() const { return m_reports; }
+    LatencyStats                        latency_stats() const;
+    void                                print_latency(const char* name) const;
+    void                                clear();
+
+private:
+    static uint8_t keyboard_leds(void);
+    static void    send_keyboard(report_keyboard_t* report);
+    static void    send_mouse(report_mouse_t* report);
+    static void    send_system(uint16_t data);
+    static void    send_consumer(uint16_t data);
+
+    host_driver_t                m_driver;
+    std::vector<SimulatedReport> m_reports;
+    std::vector<uint32_t>        m_pending;
+    uint32_t                     m_last_cause = 0;
+    static TestSimulator*        m_this;
+};
@@ -0,0 +1,225 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <array>
+#include <vector>
+
+extern "C" {
+#include "via.h"
+#include "dynamic_keymap.h"
+#include "raw_hid.h"
+}
+
+#define REPORT_SIZE 32
+#define PAYLOAD_SIZE (REPORT_SIZE - 2)
+#define KEYMAP_SIZE (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2)
+
+typedef std::array<uint8_t, REPORT_SIZE> report_t;
+
+static std::vector<report_t> sent_reports;
+
+extern "C" void raw_hid_send(uint8_t *data, uint8_t length) {
+    report_t report;
+    std::copy(data, data + length, report.begin());
+    sent_reports.push_back(report);
+}
+
+static uint16_t crc16(const std::vector<uint8_t> &data) {
+    uint16_t crc = 0xFFFF;
+    for (uint8_t byte : data) {
+        crc ^= byte << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+class ViaBulk : public TestFixture {
+   public:
+    ViaBulk() { sent_reports.clear(); }
+
+    // Sends one report to the keyboard, returns the reports it sent back
+    std::vector<report_t> receive(std::vector<uint8_t> bytes) {
+        report_t report = {};
+        std::copy(bytes.begin(), bytes.end(), report.begin());
+        sent_reports.clear();
+        raw_hid_receive(report.data(), REPORT_SIZE);
+        return sent_reports;
+    }
+
+    std::vector<report_t> begin(uint8_t target, uint16_t offset, uint16_t length) {
+        return receive({id_bulk_write_begin, target, (uint8_t)(offset >> 8), (uint8_t)offset, (uint8_t)(length >> 8), (uint8_t)length});
+    }
+
+    void data(uint8_t seq, const std::vector<uint8_t> &data, size_t start) {
+        std::vector<uint8_t> bytes = {id_bulk_write_data, seq};
+        for (size_t i = start; i < data.size() && i < start + PAYLOAD_SIZE; i++) {
+            bytes.push_back(data[i]);
+        }
+        EXPECT_TRUE(receive(bytes).empty());
+    }
+
+    uint8_t commit(uint16_t crc) {
+        auto replies = receive({id_bulk_write_commit, (uint8_t)(crc >> 8), (uint8_t)crc});
+        EXPECT_EQ(replies.size(), 1);
+        return replies.empty() ? 0xFF : replies[0][3];
+    }
+
+    std::vector<uint8_t> stored_keymap() {
+        std::vector<uint8_t> keymap(KEYMAP_SIZE);
+        dynamic_keymap_get_buffer(0, keymap.size(), keymap.data());
+        return keymap;
+    }
+
+    std::vector<uint8_t> keymap_pattern(uint8_t seed) {
+        std::vector<uint8_t> keymap(KEYMAP_SIZE);
+        for (size_t i = 0; i < keymap.size(); i++) {
+            keymap[i] = seed + i * 7;
+        }
+        return keymap;
+    }
+};
+
+TEST_F(ViaBulk, WritesTheKeymapWithOneReplyPerSession) {
+    auto keymap = keymap_pattern(1);
+
+    auto replies = begin(id_bulk_keymap, 0, keymap.size());
+    ASSERT_EQ(replies.size(), 1);
+    EXPECT_EQ(replies[0][6], via_bulk_ok);
+    EXPECT_EQ(replies[0][7], PAYLOAD_SIZE);
+    EXPECT_EQ((replies[0][8] << 8) | replies[0][9], VIA_BULK_WRITE_SIZE);
+
+    // nothing is written before the commit
+    auto    before = stored_keymap();
+    uint8_t seq    = 0;
+    for (size_t i = 0; i < keymap.size(); i += PAYLOAD_SIZE) {
+        data(seq++, keymap, i);
+    }
+    EXPECT_EQ(stored_keymap(), before);
+
+    EXPECT_EQ(commit(crc16(keymap)), via_bulk_ok);
+    EXPECT_TRUE(via_eeprom_is_valid());
+    EXPECT_EQ(stored_keymap(), keymap);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 0, 1), (keymap[2] << 8) | keymap[3]);
+}
+
+TEST_F(ViaBulk, ReadsInOneRequest) {
+    auto keymap = keymap_pattern(3);
+    dynamic_keymap_set_buffer(0, keymap.size(), keymap.data());
+
+    auto replies = receive({id_bulk_read, id_bulk_keymap, 0, 0, 0, (uint8_t)keymap.size()});
+    size_t data_reports = (keymap.size() + PAYLOAD_SIZE - 1) / PAYLOAD_SIZE;
+    ASSERT_EQ(replies.size(), 1 + data_reports);
+    EXPECT_EQ(replies[0][6], via_bulk_ok);
+    EXPECT_EQ((replies[0][7] << 8) | replies[0][8], crc16(keymap));
+    EXPECT_EQ(replies[0][9], PAYLOAD_SIZE);
+
+    std::vector<uint8_t> read;
+    for (size_t i = 1; i < replies.size(); i++) {
+        EXPECT_EQ(replies[i][0], id_bulk_read);
+        EXPECT_EQ(replies[i][1], i - 1);
+        read.insert(read.end(), replies[i].begin() + 2, replies[i].end());
+    }
+    read.resize(keymap.size());
+    EXPECT_EQ(read, keymap);
+}
+
+TEST_F(ViaBulk, LostReportFailsTheCommit) {
+    auto keymap = keymap_pattern(5);
+    auto before = stored_keymap();
+
+    begin(id_bulk_keymap, 0, keymap.size());
+    data(0, keymap, 0);
+    data(2, keymap, 2 * PAYLOAD_SIZE);
+    EXPECT_EQ(commit(crc16(keymap)), via_bulk_bad_sequence);
+    EXPECT_TRUE(via_eeprom_is_valid());
+    EXPECT_EQ(stored_keymap(), before);
+}
+
+TEST_F(ViaBulk, MissingDataFailsTheCommit) {
+    auto keymap = keymap_pattern(7);
+
+    begin(id_bulk_keymap, 0, keymap.size());
+    data(0, keymap, 0);
+    EXPECT_EQ(commit(crc16(keymap)), via_bulk_bad_sequence);
+}
+
+TEST_F(ViaBulk, CorruptDataFailsTheCommit) {
+    auto keymap = keymap_pattern(9);
+    auto sent   = keymap;
+    auto before = stored_keymap();
+    sent[40] ^= 0x10;
+
+    begin(id_bulk_keymap, 0, keymap.size());
+    uint8_t seq = 0;
+    for (size_t i = 0; i < sent.size(); i += PAYLOAD_SIZE) {
+        data(seq++, sent, i);
+    }
+    EXPECT_EQ(commit(crc16(keymap)), via_bulk_bad_crc);
+    EXPECT_TRUE(via_eeprom_is_valid());
+    EXPECT_EQ(stored_keymap(), before);
+}
+
+TEST_F(ViaBulk, WritesMacrosAtAnOffset) {
+    std::vector<uint8_t> macro = {'h', 'i', 0, 'o', 'k', 0};
+
+    begin(id_bulk_macro, 10, macro.size());
+    data(0, macro, 0);
+    EXPECT_EQ(commit(crc16(macro)), via_bulk_ok);
+
+    std::vector<uint8_t> stored(macro.size());
+    dynamic_keymap_macro_get_buffer(10, stored.size(), stored.data());
+    EXPECT_EQ(stored, macro);
+}
+
+TEST_F(ViaBulk, CorruptMacrosAreNotWritten) {
+    std::vector<uint8_t> macro = {'h', 'i', 0};
+    std::vector<uint8_t> sent  = {'h', 'i', 'x'};
+
+    begin(id_bulk_macro, 0, macro.size());
+    data(0, macro, 0);
+    EXPECT_EQ(commit(crc16(macro)), via_bulk_ok);
+
+    // an unterminated macro would run into the next one
+    begin(id_bulk_macro, 0, sent.size());
+    data(0, sent, 0);
+    EXPECT_EQ(commit(crc16(macro)), via_bulk_bad_crc);
+
+    std::vector<uint8_t> stored(macro.size());
+    dynamic_keymap_macro_get_buffer(0, stored.size(), stored.data());
+    EXPECT_EQ(stored, macro);
+}
+
+TEST_F(ViaBulk, RejectsSessionsLongerThanTheStagingBuffer) {
+    auto replies = begin(id_bulk_macro, 0, VIA_BULK_WRITE_SIZE + 1);
+    ASSERT_EQ(replies.size(), 1);
+    EXPECT_EQ(replies[0][6], via_bulk_too_large);
+    EXPECT_EQ((replies[0][8] << 8) | replies[0][9], VIA_BULK_WRITE_SIZE);
+    EXPECT_EQ(commit(0), via_bulk_not_started);
+}
+
+TEST_F(ViaBulk, RejectsBadRequests) {
+    auto replies = begin(id_bulk_keymap, 2, KEYMAP_SIZE);
+    ASSERT_EQ(replies.size(), 1);
+    EXPECT_EQ(replies[0][6], via_bulk_bad_range);
+    EXPECT_EQ(commit(0), via_bulk_not_started);
+
+    replies = receive({id_bulk_read, 0x55, 0, 0, 0, 1});
+    ASSERT_EQ(replies.size(), 1);
+    EXPECT_EQ(replies[0][6], via_bulk_bad_range);
+}
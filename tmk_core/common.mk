@@ -90,6 +90,16 @@ ifeq ($(strip $(COMMAND_ENABLE)), yes)
     TMK_COMMON_DEFS += -DCOMMAND_ENABLE
 endif
 
+ifeq ($(strip $(SCAN_PROFILE_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/scan_profile.c
+    TMK_COMMON_DEFS += -DSCAN_PROFILE_ENABLE
+endif
+
+ifeq ($(strip $(EEPROM_CACHE_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/eeprom_cache.c
+    TMK_COMMON_DEFS += -DEEPROM_CACHE_ENABLE
+endif
+
 ifeq ($(strip $(NKRO_ENABLE)), yes)
     TMK_COMMON_DEFS += -DNKRO_ENABLE
     SHARED_EP_ENABLE = yes
@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_tapping.h"
 #include "action_macro.h"
 #include "action_util.h"
+#include "scan_profile.h"
 #include "action.h"
 #include "wait.h"
 
@@ -185,7 +186,10 @@ void process_record(keyrecord_t *record) {
         return;
     }
 
-    if (!process_record_quantum(record)) return;
+    scan_profile_begin(SCAN_PROFILE_PROCESS_RECORD_QUANTUM);
+    bool keep_going = process_record_quantum(record);
+    scan_profile_end(SCAN_PROFILE_PROCESS_RECORD_QUANTUM);
+    if (!keep_going) return;
 
     process_record_handler(record);
     post_process_record_quantum(record);
@@ -3,6 +3,10 @@
 #include "action.h"
 #include "util.h"
 #include "action_layer.h"
+#include "source_layers_cache.h"
+#ifdef LAYER_LOOKUP_CACHE
+#    include "matrix.h"
+#endif
 
 #ifdef DEBUG_ACTION
 #    include "debug.h"
@@ -10,6 +14,52 @@
 #    include "nodebug.h"
 #endif
 
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_LOOKUP_CACHE)
+/** \brief layer lookup cache
+ *
+ * Holds the result of layer_switch_get_layer() for every key, so that a lookup doesn't have to
+ * walk (and read the keymap of) every active layer. An entry is only trusted while its bit is set
+ * in layer_lookup_valid.
+ */
+static uint8_t      layer_lookup_cache[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t layer_lookup_valid[MATRIX_ROWS];
+
+/** \brief Drop the cached entries a change of active layers can affect
+ *
+ * A key can only resolve differently if the layer it resolved to was turned off,
+ * or if a layer above it was turned on.
+ */
+static void layer_lookup_cache_update(layer_state_t from, layer_state_t to) {
+    layer_state_t disabled = from & ~to;
+    layer_state_t enabled  = to & ~from;
+
+    if (!disabled && !enabled) {
+        return;
+    }
+
+    uint8_t highest_enabled = enabled ? get_highest_layer(enabled) : 0;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        matrix_row_t col_bit = 1;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++, col_bit <<= 1) {
+            if (layer_lookup_valid[row] & col_bit) {
+                uint8_t layer = layer_lookup_cache[row][col];
+                if ((disabled & (1UL << layer)) || layer < highest_enabled) {
+                    layer_lookup_valid[row] &= ~col_bit;
+                }
+            }
+        }
+    }
+}
+
+/** \brief Forget every cached lookup, for when the keymap itself has changed
+ */
+void layer_lookup_cache_clear(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        layer_lookup_valid[row] = 0;
+    }
+}
+#endif
+
 /** \brief Default Layer State
  */
 layer_state_t default_layer_state = 0;
@@ -35,6 +85,9 @@ static void default_layer_state_set(layer_state_t state) {
     debug("default_layer_state: ");
     default_layer_debug();
     debug(" to ");
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_LOOKUP_CACHE)
+    layer_lookup_cache_update(layer_state | default_layer_state, layer_state | state);
+#endif
     default_layer_state = state;
     default_layer_debug();
     debug("\n");
@@ -101,6 +154,9 @@ void layer_state_set(layer_state_t state) {
     dprint("layer_state: ");
     layer_debug();
     dprint(" to ");
+#    ifdef LAYER_LOOKUP_CACHE
+    layer_lookup_cache_update(layer_state | default_layer_state, state | default_layer_state);
+#    endif
     layer_state = state;
     layer_debug();
     dprintln();
@@ -182,23 +238,54 @@ void layer_debug(void) { dprintf("%08lX(%u)", layer_state, get_highest_layer(lay
 #endif
 
 #if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
+#    define SOURCE_LAYERS_CACHE_KEYS (MATRIX_ROWS * MATRIX_COLS)
+
+/* Use the fastest layout that fits the RAM budget, which by default is what the bit-planes would take on AVR. */
+#    ifndef SOURCE_LAYERS_CACHE_RAM_BUDGET
+#        if defined(__AVR__)
+#            define SOURCE_LAYERS_CACHE_RAM_BUDGET SOURCE_LAYERS_CACHE_BITPLANE_SIZE(SOURCE_LAYERS_CACHE_KEYS, MAX_LAYER_BITS)
+#        else
+#            define SOURCE_LAYERS_CACHE_RAM_BUDGET SOURCE_LAYERS_CACHE_BYTE_SIZE(SOURCE_LAYERS_CACHE_KEYS)
+#        endif
+#    endif
+
+#    ifndef SOURCE_LAYERS_CACHE_LAYOUT
+#        if SOURCE_LAYERS_CACHE_BYTE_SIZE(SOURCE_LAYERS_CACHE_KEYS) <= SOURCE_LAYERS_CACHE_RAM_BUDGET
+#            define SOURCE_LAYERS_CACHE_LAYOUT SOURCE_LAYERS_CACHE_BYTE
+#        elif MAX_LAYER_BITS <= 4
+#            define SOURCE_LAYERS_CACHE_LAYOUT SOURCE_LAYERS_CACHE_NIBBLE
+#        else
+#            define SOURCE_LAYERS_CACHE_LAYOUT SOURCE_LAYERS_CACHE_BITPLANE
+#        endif
+#    endif
+
 /** \brief source layer cache
  */
-
-uint8_t source_layers_cache[(MATRIX_ROWS * MATRIX_COLS + 7) / 8][MAX_LAYER_BITS] = {{0}};
+#    if SOURCE_LAYERS_CACHE_LAYOUT == SOURCE_LAYERS_CACHE_BYTE
+uint8_t source_layers_cache[SOURCE_LAYERS_CACHE_BYTE_SIZE(SOURCE_LAYERS_CACHE_KEYS)] = {0};
+#    elif SOURCE_LAYERS_CACHE_LAYOUT == SOURCE_LAYERS_CACHE_NIBBLE
+#        if MAX_LAYER_BITS > 4
+#            error "The nibble source layers cache only holds 16 layers, use LAYER_STATE_16BIT or LAYER_STATE_8BIT"
+#        endif
+uint8_t source_layers_cache[SOURCE_LAYERS_CACHE_NIBBLE_SIZE(SOURCE_LAYERS_CACHE_KEYS)] = {0};
+#    else
+uint8_t source_layers_cache[SOURCE_LAYERS_CACHE_BITPLANE_SIZE(SOURCE_LAYERS_CACHE_KEYS, MAX_LAYER_BITS)] = {0};
+#    endif
 
 /** \brief update source layers cache
  *
  * Updates the cached keys when changing layers
  */
 void update_source_layers_cache(keypos_t key, uint8_t layer) {
-    const uint8_t key_number  = key.col + (key.row * MATRIX_COLS);
-    const uint8_t storage_row = key_number / 8;
-    const uint8_t storage_bit = key_number % 8;
+    const uint16_t key_number = key.col + (key.row * MATRIX_COLS);
 
-    for (uint8_t bit_number = 0; bit_number < MAX_LAYER_BITS; bit_number++) {
-        source_layers_cache[storage_row][bit_number] ^= (-((layer & (1U << bit_number)) != 0) ^ source_layers_cache[storage_row][bit_number]) & (1U << storage_bit);
-    }
+#    if SOURCE_LAYERS_CACHE_LAYOUT == SOURCE_LAYERS_CACHE_BYTE
+    source_layers_cache_byte_write(source_layers_cache, key_number, layer);
+#    elif SOURCE_LAYERS_CACHE_LAYOUT == SOURCE_LAYERS_CACHE_NIBBLE
+    source_layers_cache_nibble_write(source_layers_cache, key_number, layer);
+#    else
+    source_layers_cache_bitplane_write(source_layers_cache, MAX_LAYER_BITS, key_number, layer);
+#    endif
 }
 
 /** \brief read source layers cache
@@ -206,16 +293,15 @@ void update_source_layers_cache(keypos_t key, uint8_t layer) {
  * reads the cached keys stored when the layer was changed
  */
 uint8_t read_source_layers_cache(keypos_t key) {
-    const uint8_t key_number  = key.col + (key.row * MATRIX_COLS);
-    const uint8_t storage_row = key_number / 8;
-    const uint8_t storage_bit = key_number % 8;
-    uint8_t       layer       = 0;
+    const uint16_t key_number = key.col + (key.row * MATRIX_COLS);
 
-    for (uint8_t bit_number = 0; bit_number < MAX_LAYER_BITS; bit_number++) {
-        layer |= ((source_layers_cache[storage_row][bit_number] & (1U << storage_bit)) != 0) << bit_number;
-    }
-
-    return layer;
+#    if SOURCE_LAYERS_CACHE_LAYOUT == SOURCE_LAYERS_CACHE_BYTE
+    return source_layers_cache_byte_read(source_layers_cache, key_number);
+#    elif SOURCE_LAYERS_CACHE_LAYOUT == SOURCE_LAYERS_CACHE_NIBBLE
+    return source_layers_cache_nibble_read(source_layers_cache, key_number);
+#    else
+    return source_layers_cache_bitplane_read(source_layers_cache, MAX_LAYER_BITS, key_number);
+#    endif
 }
 #endif
 
@@ -255,18 +341,34 @@ uint8_t layer_switch_get_layer(keypos_t key) {
     action_t action;
     action.code = ACTION_TRANSPARENT;
 
+#    ifdef LAYER_LOOKUP_CACHE
+    bool         cacheable = key.row < MATRIX_ROWS && key.col < MATRIX_COLS;
+    matrix_row_t col_bit   = (matrix_row_t)1 << key.col;
+    if (cacheable && (layer_lookup_valid[key.row] & col_bit)) {
+        return layer_lookup_cache[key.row][key.col];
+    }
+#    endif
+
+    uint8_t       layer  = 0;
     layer_state_t layers = layer_state | default_layer_state;
     /* check top layer first */
     for (int8_t i = sizeof(layer_state_t) * 8 - 1; i >= 0; i--) {
         if (layers & (1UL << i)) {
             action = action_for_key(i, key);
             if (action.code != ACTION_TRANSPARENT) {
-                return i;
+                layer = i;
+                break;
             }
         }
     }
     /* fall back to layer 0 */
-    return 0;
+#    ifdef LAYER_LOOKUP_CACHE
+    if (cacheable) {
+        layer_lookup_cache[key.row][key.col] = layer;
+        layer_lookup_valid[key.row] |= col_bit;
+    }
+#    endif
+    return layer;
 #else
     return get_highest_layer(default_layer_state);
 #endif
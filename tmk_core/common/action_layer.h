@@ -96,13 +96,25 @@ layer_state_t layer_state_set_kb(layer_state_t state);
 
 /* pressed actions cache */
 #if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
-/* The number of bits needed to represent the layer number: log2(32). */
-#    define MAX_LAYER_BITS 5
+/* The number of bits needed to represent the layer number: log2 of the number of layers. */
+#    if defined(LAYER_STATE_8BIT)
+#        define MAX_LAYER_BITS 3
+#    elif defined(LAYER_STATE_16BIT)
+#        define MAX_LAYER_BITS 4
+#    else
+#        define MAX_LAYER_BITS 5
+#    endif
 void    update_source_layers_cache(keypos_t key, uint8_t layer);
 uint8_t read_source_layers_cache(keypos_t key);
 #endif
 action_t store_or_get_action(bool pressed, keypos_t key);
 
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_LOOKUP_CACHE)
+void layer_lookup_cache_clear(void);
+#else
+#    define layer_lookup_cache_clear()
+#endif
+
 /* return the topmost non-transparent layer currently associated with key */
 uint8_t layer_switch_get_layer(keypos_t key);
 
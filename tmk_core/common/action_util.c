@@ -42,6 +42,39 @@ static int8_t cb_count = 0;
 // report_keyboard_t keyboard_report = {};
 report_keyboard_t *keyboard_report = &(report_keyboard_t){};
 
+#ifdef QMK_BATCH_KEY_EVENTS
+static bool              report_batching = false;
+static bool              batch_pending   = false;
+static report_keyboard_t batched_report  = {};
+static report_keyboard_t batch_base      = {};
+
+/** \brief Checks if a key pressed since `base` is held in one report but missing from another
+ *
+ * Coalescing two such reports would hide a press from the host, so they have to be sent separately.
+ */
+static bool report_drops_keys(report_keyboard_t *base, report_keyboard_t *from, report_keyboard_t *to) {
+    if (from->mods & ~to->mods & ~base->mods) {
+        return true;
+    }
+#    ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            if (from->nkro.bits[i] & ~to->nkro.bits[i] & ~base->nkro.bits[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+#    endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (from->keys[i] && !is_key_pressed(to, from->keys[i]) && !is_key_pressed(base, from->keys[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
 extern inline void add_key(uint8_t key);
 extern inline void del_key(uint8_t key);
 extern inline void clear_keys(void);
@@ -152,10 +185,44 @@ void send_keyboard_report(void) {
         }
     }
 
+#endif
+#ifdef QMK_BATCH_KEY_EVENTS
+    if (report_batching) {
+        // a key that came and went inside the batch still has to reach the host
+        if (batch_pending && report_drops_keys(&batch_base, &batched_report, keyboard_report)) {
+            host_keyboard_send(&batched_report);
+            batch_base = batched_report;
+        }
+        batched_report = *keyboard_report;
+        batch_pending  = true;
+        return;
+    }
 #endif
     host_keyboard_send(keyboard_report);
 }
 
+#ifdef QMK_BATCH_KEY_EVENTS
+/** \brief Start collecting keyboard reports
+ *
+ * Until keyboard_report_batch_flush() is called, send_keyboard_report() only records the
+ * latest report, so that all the events of one matrix scan go out to the host together.
+ */
+void keyboard_report_batch_start(void) {
+    batch_base      = *keyboard_report;
+    report_batching = true;
+}
+
+/** \brief Send the report collected since keyboard_report_batch_start(), if any
+ */
+void keyboard_report_batch_flush(void) {
+    report_batching = false;
+    if (batch_pending) {
+        batch_pending = false;
+        host_keyboard_send(&batched_report);
+    }
+}
+#endif
+
 /** \brief Get mods
  *
  * FIXME: needs doc
@@ -28,6 +28,11 @@ extern report_keyboard_t *keyboard_report;
 
 void send_keyboard_report(void);
 
+#ifdef QMK_BATCH_KEY_EVENTS
+void keyboard_report_batch_start(void);
+void keyboard_report_batch_flush(void);
+#endif
+
 /* key */
 inline void add_key(uint8_t key) { add_key_to_report(keyboard_report, key); }
 
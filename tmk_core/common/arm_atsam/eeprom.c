@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#define EEPROM_CACHE_BACKEND
 #include "eeprom.h"
 
 #ifndef EEPROM_SIZE
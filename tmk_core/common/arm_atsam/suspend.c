@@ -2,6 +2,9 @@
 #include "i2c_master.h"
 #include "led_matrix.h"
 #include "suspend.h"
+#ifdef EEPROM_CACHE_ENABLE
+#    include "eeprom.h"
+#endif
 
 /** \brief Suspend idle
  *
@@ -30,6 +33,9 @@ void suspend_power_down(void) {
 #ifdef RGB_MATRIX_ENABLE
     I2C3733_Control_Set(0);  // Disable LED driver
 #endif
+#ifdef EEPROM_CACHE_ENABLE
+    eeprom_cache_flush();
+#endif
 
     suspend_power_down_kb();
 }
@@ -58,6 +64,14 @@ __attribute__((weak)) void suspend_wakeup_init_user(void) {}
  */
 __attribute__((weak)) void suspend_wakeup_init_kb(void) { suspend_wakeup_init_user(); }
 
+#ifdef MATRIX_IDLE_TIMEOUT
+/** \brief Sleep until a key may have been pressed
+ *
+ * Not implemented, the matrix is scanned continuously.
+ */
+bool suspend_idle_sleep(void) { return false; }
+#endif
+
 /** \brief run immediately after wakeup
  *
  * FIXME: needs doc
@@ -22,6 +22,10 @@
 #    include "audio.h"
 #endif /* AUDIO_ENABLE */
 
+#ifdef EEPROM_CACHE_ENABLE
+#    include "eeprom.h"
+#endif
+
 #if defined(RGBLIGHT_SLEEP) && defined(RGBLIGHT_ENABLE)
 #    include "rgblight.h"
 extern rgblight_config_t rgblight_config;
@@ -55,7 +59,7 @@ __attribute__((weak)) void suspend_power_down_user(void) {}
  */
 __attribute__((weak)) void suspend_power_down_kb(void) { suspend_power_down_user(); }
 
-#ifndef NO_SUSPEND_POWER_DOWN
+#if !defined(NO_SUSPEND_POWER_DOWN) || defined(MATRIX_IDLE_TIMEOUT)
 /** \brief Power down MCU with watchdog timer
  *
  * wdto: watchdog timer timeout defined in <avr/wdt.h>
@@ -71,7 +75,9 @@ __attribute__((weak)) void suspend_power_down_kb(void) { suspend_power_down_user
  *          WDTO_8S
  */
 static uint8_t wdt_timeout = 0;
+#endif
 
+#ifndef NO_SUSPEND_POWER_DOWN
 /** \brief Power down
  *
  * FIXME: needs doc
@@ -135,6 +141,9 @@ static void power_down(uint8_t wdto) {
  * FIXME: needs doc
  */
 void suspend_power_down(void) {
+#ifdef EEPROM_CACHE_ENABLE
+    eeprom_cache_flush();
+#endif
     suspend_power_down_kb();
 
 #ifndef NO_SUSPEND_POWER_DOWN
@@ -154,6 +163,53 @@ bool                       suspend_wakeup_condition(void) {
     return false;
 }
 
+#ifdef MATRIX_IDLE_TIMEOUT
+// On these parts PCINT0-7 are the Port B pins
+#    if defined(__AVR_ATmega16U2__) || defined(__AVR_ATmega32U2__) || defined(__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__) || defined(__AVR_AT90USB646__) || defined(__AVR_AT90USB647__) || defined(__AVR_AT90USB1286__) || defined(__AVR_AT90USB1287__) || defined(__AVR_ATmega328P__)
+#        define IDLE_WAKE_PCINT_PORTB
+// Keyboards with their own PCINT0 handler define MATRIX_IDLE_PCINT0_HANDLED,
+// that handler then also runs on each wake-up
+#        ifndef MATRIX_IDLE_PCINT0_HANDLED
+EMPTY_INTERRUPT(PCINT0_vect);
+#        endif
+#    endif
+
+/** \brief Sleep until a key may have been pressed
+ *
+ * Expects the matrix to be armed with matrix_wake_arm(). Powers down until
+ * the watchdog fires, or earlier when a pulled-up input on Port B changes,
+ * so switches wired to Port B wake the MCU as soon as they close and the
+ * others within 15ms.
+ */
+bool suspend_idle_sleep(void) {
+#    ifdef PROTOCOL_LUFA
+    if (USB_DeviceState == DEVICE_STATE_Configured) return false;
+#    endif
+#    ifdef IDLE_WAKE_PCINT_PORTB
+    uint8_t pcmsk0 = PCMSK0;
+    uint8_t pcicr  = PCICR;
+    PCMSK0 |= ~DDRB & PORTB;
+    PCIFR = _BV(PCIF0);
+    PCICR |= _BV(PCIE0);
+#    endif
+    wdt_timeout = WDTO_15MS;
+    wdt_intr_enable(WDTO_15MS);
+
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    wdt_disable();
+#    ifdef IDLE_WAKE_PCINT_PORTB
+    PCICR  = pcicr;
+    PCMSK0 = pcmsk0;
+#    endif
+    return true;
+}
+#endif
+
 /** \brief run user level code immediately after wakeup
  *
  * FIXME: needs doc
@@ -189,7 +245,7 @@ void suspend_wakeup_init(void) {
     suspend_wakeup_init_kb();
 }
 
-#ifndef NO_SUSPEND_POWER_DOWN
+#if !defined(NO_SUSPEND_POWER_DOWN) || defined(MATRIX_IDLE_TIMEOUT)
 /* watchdog timeout */
 ISR(WDT_vect) {
     // compensate timer for sleep
@@ -17,6 +17,7 @@
  */
 
 #include <stdio.h>
+#include <stdbool.h>
 #include <string.h>
 #include "eeprom_stm32.h"
 /*****************************************************************************
@@ -24,16 +25,91 @@
  * the functionality use the EEPROM_Init() function. Be sure that by reprogramming
  * of the controller just affected pages will be deleted. In other case the non
  * volatile data will be lost.
+ *
+ * The pages are used as two banks, and one of them is live at a time:
+ *
+ *   header:  sequence number, FEE_BANK_MAGIC (written last, marks the bank valid)
+ *   image:   FEE_DENSITY_BYTES, the EEPROM contents at the last compaction
+ *   log:     (address, value | ~value << 8) half-word pairs, appended on every write
+ *
+ * A copy of the EEPROM is kept in RAM, so reads never touch flash and a write
+ * is two half-word programs. When the log is full, the RAM copy is written to
+ * the image of the other bank, which becomes live once its header is written;
+ * a reset at any point leaves one of the banks valid.
  ******************************************************************************/
 
-/* Private macro -------------------------------------------------------------*/
+_Static_assert(FEE_DENSITY_BYTES % 2 == 0 && FEE_LOG_RECORDS >= 16, "FEE_DENSITY_BYTES must be even, and leave room for at least 16 log records in a bank");
+
+#ifndef FLASH_STM32_MOCKED
+// Publishes the first EEPROM page as __eeprom_emu_base__, so that eeprom_stm32.ld
+// can fail the link when the firmware grows into the EEPROM pages
+static void __attribute__((used)) FEE_ExportBase(void) { __asm__(".global __eeprom_emu_base__\n\t.equ __eeprom_emu_base__, %c0" : : "i"(FEE_PAGE_BASE_ADDRESS)); }
+#endif
+
 /* Private variables ---------------------------------------------------------*/
+static uint8_t  DataBuf[FEE_DENSITY_BYTES];
+static uint8_t  ActiveBank;
+static uint16_t ActiveSequence;
+static uint16_t LogRecords;
+
 /* Functions -----------------------------------------------------------------*/
+static inline uint16_t FEE_ReadHalfWord(uint32_t Address) { return *(const uint16_t *)FEE_FLASH(Address); }
+
+static inline bool FEE_BankValid(uint8_t Bank) { return FEE_ReadHalfWord(FEE_BANK_ADDRESS(Bank) + 2) == FEE_BANK_MAGIC; }
+
+static inline uint16_t FEE_BankSequence(uint8_t Bank) { return FEE_ReadHalfWord(FEE_BANK_ADDRESS(Bank)); }
+
+static FLASH_Status FEE_EraseBank(uint8_t Bank) {
+    FLASH_Status FlashStatus = FLASH_COMPLETE;
+
+    for (int page_num = 0; page_num < FEE_BANK_PAGES && FlashStatus == FLASH_COMPLETE; page_num++) {
+        uint32_t page = FEE_BANK_ADDRESS(Bank) + page_num * FEE_PAGE_SIZE;
+        // skip pages that are already blank, erasing is what wears the flash out
+        for (uint32_t i = 0; i < FEE_PAGE_SIZE; i += 2) {
+            if (FEE_ReadHalfWord(page + i) != FEE_EMPTY_WORD) {
+                FlashStatus = FLASH_ErasePage(page);
+                break;
+            }
+        }
+    }
+    return FlashStatus;
+}
+
+/*****************************************************************************
+ *  Write the RAM copy to the image of the other bank and switch to it. The
+ *  old bank is left alone until the next compaction erases it.
+ ******************************************************************************/
+static FLASH_Status FEE_Compact(void) {
+    uint8_t      bank        = ActiveBank ^ 1;
+    uint16_t     sequence    = ActiveSequence + 1;
+    uint32_t     base        = FEE_BANK_ADDRESS(bank);
+    FLASH_Status FlashStatus = FEE_EraseBank(bank);
+
+    if (sequence == FEE_EMPTY_WORD) {
+        sequence = 0;
+    }
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES && FlashStatus == FLASH_COMPLETE; i += 2) {
+        uint16_t data = DataBuf[i] | (DataBuf[i + 1] << 8);
+        if (data != FEE_EMPTY_WORD) {
+            FlashStatus = FLASH_ProgramHalfWord(base + FEE_HEADER_SIZE + i, data);
+        }
+    }
+    if (FlashStatus == FLASH_COMPLETE) {
+        FlashStatus = FLASH_ProgramHalfWord(base, sequence);
+    }
+    if (FlashStatus == FLASH_COMPLETE) {
+        FlashStatus = FLASH_ProgramHalfWord(base + 2, FEE_BANK_MAGIC);
+    }
+    if (FlashStatus == FLASH_COMPLETE) {
+        ActiveBank     = bank;
+        ActiveSequence = sequence;
+        LogRecords     = 0;
+    }
+    return FlashStatus;
+}
 
-uint8_t DataBuf[FEE_PAGE_SIZE];
 /*****************************************************************************
- *  Delete Flash Space used for user Data, deletes the whole space between
- *  RW_PAGE_BASE_ADDRESS and the last uC Flash Page
+ *  Find the live bank and rebuild the RAM copy from its image and log.
  ******************************************************************************/
 uint16_t EEPROM_Init(void) {
     // unlock flash
@@ -42,63 +118,93 @@ uint16_t EEPROM_Init(void) {
     // Clear Flags
     // FLASH_ClearFlag(FLASH_SR_EOP|FLASH_SR_PGERR|FLASH_SR_WRPERR);
 
+    bool valid0 = FEE_BankValid(0);
+    bool valid1 = FEE_BankValid(1);
+
+    if (!valid0 && !valid1) {
+        // Nothing written in this format yet: pick up whatever the old one byte
+        // per half-word layout left, as far as it fits in the bank it starts
+        // in, and compact it into the other bank to start the log. On chips
+        // where the old layout used fewer pages, it starts in bank 1.
+        uint32_t end = FEE_BANK_ADDRESS(FEE_LEGACY_BANK) + FEE_BANK_SIZE;
+
+        memset(DataBuf, 0xFF, sizeof(DataBuf));
+        for (uint16_t i = 0; i < FEE_DENSITY_BYTES && i < FEE_LEGACY_BYTES && FEE_LEGACY_ADDRESS + i * 2 < end; i++) {
+            DataBuf[i] = *FEE_FLASH(FEE_LEGACY_ADDRESS + i * 2);
+        }
+        ActiveBank     = FEE_LEGACY_BANK;
+        ActiveSequence = FEE_EMPTY_WORD;
+        FEE_Compact();
+        return FEE_DENSITY_BYTES;
+    }
+
+    // If a reset hit between a compaction and the next one erasing the old
+    // bank, both are valid; the newer one wins.
+    if (valid0 && valid1) {
+        ActiveBank = (uint16_t)(FEE_BankSequence(1) - FEE_BankSequence(0)) < 0x8000 ? 1 : 0;
+    } else {
+        ActiveBank = valid1 ? 1 : 0;
+    }
+    ActiveSequence = FEE_BankSequence(ActiveBank);
+
+    uint32_t base = FEE_BANK_ADDRESS(ActiveBank);
+    memcpy(DataBuf, FEE_FLASH(base + FEE_HEADER_SIZE), FEE_DENSITY_BYTES);
+
+    // Replay the log. Records are programmed address first, so a record cut off
+    // by a reset fails the value check and is skipped.
+    LogRecords = 0;
+    for (uint16_t i = 0; i < FEE_LOG_RECORDS; i++) {
+        uint32_t record  = base + FEE_LOG_OFFSET + i * FEE_LOG_RECORD_SIZE;
+        uint16_t address = FEE_ReadHalfWord(record);
+        uint16_t value   = FEE_ReadHalfWord(record + 2);
+
+        if (address == FEE_EMPTY_WORD && value == FEE_EMPTY_WORD) {
+            break;
+        }
+        LogRecords = i + 1;
+        if (address < FEE_DENSITY_BYTES && (value >> 8) == (uint8_t)~value) {
+            DataBuf[address] = (uint8_t)value;
+        }
+    }
+
     return FEE_DENSITY_BYTES;
 }
 /*****************************************************************************
- *  Erase the whole reserved Flash Space used for user Data
+ *  Erase the whole reserved Flash Space used for user Data. A blank image is
+ *  compacted into the other bank, so this costs one bank worth of erases.
  ******************************************************************************/
 void EEPROM_Erase(void) {
-    int page_num = 0;
-
-    // delete all pages from specified start page to the last page
-    do {
-        FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page_num * FEE_PAGE_SIZE));
-        page_num++;
-    } while (page_num < FEE_DENSITY_PAGES);
+    memset(DataBuf, 0xFF, sizeof(DataBuf));
+    FEE_Compact();
 }
 /*****************************************************************************
- *  Writes once data byte to flash on specified address. If a byte is already
- *  written, the whole page must be copied to a buffer, the byte changed and
- *  the manipulated buffer written after PageErase.
+ *  Writes once data byte to flash on specified address. The byte is appended
+ *  to the log of the live bank; only when the log is full is the data
+ *  compacted into the other bank, which erases its pages.
  *******************************************************************************/
 uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
     FLASH_Status FlashStatus = FLASH_COMPLETE;
 
-    uint32_t page;
-    int      i;
-
     // exit if desired address is above the limit (e.G. under 2048 Bytes for 4 pages)
-    if (Address > FEE_DENSITY_BYTES) {
+    if (Address >= FEE_DENSITY_BYTES) {
         return 0;
     }
 
-    // calculate which page is affected (Pagenum1/Pagenum2...PagenumN)
-    page = FEE_ADDR_OFFSET(Address) / FEE_PAGE_SIZE;
-
-    // if current data is 0xFF, the byte is empty, just overwrite with the new one
-    if ((*(__IO uint16_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address))) == FEE_EMPTY_WORD) {
-        FlashStatus = FLASH_ProgramHalfWord(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address), (uint16_t)(0x00FF & DataByte));
-    } else {
-        // Copy Page to a buffer
-        memcpy(DataBuf, (uint8_t *)FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE), FEE_PAGE_SIZE);  // !!! Calculate base address for the desired page
-
-        // check if new data is differ to current data, return if not, proceed if yes
-        if (DataByte == *(__IO uint8_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address))) {
-            return 0;
-        }
-
-        // manipulate desired data byte in temp data array if new byte is differ to the current
-        DataBuf[FEE_ADDR_OFFSET(Address) % FEE_PAGE_SIZE] = DataByte;
+    // check if new data is differ to current data, return if not, proceed if yes
+    if (DataBuf[Address] == DataByte) {
+        return FlashStatus;
+    }
+    DataBuf[Address] = DataByte;
 
-        // Erase Page
-        FlashStatus = FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE));
+    if (LogRecords >= FEE_LOG_RECORDS) {
+        return FEE_Compact();
+    }
 
-        // Write new data (whole page) to flash if data has been changed
-        for (i = 0; i < (FEE_PAGE_SIZE / 2); i++) {
-            if ((__IO uint16_t)(0xFF00 | DataBuf[FEE_ADDR_OFFSET(i)]) != 0xFFFF) {
-                FlashStatus = FLASH_ProgramHalfWord((FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE)) + (i * 2), (uint16_t)(0xFF00 | DataBuf[FEE_ADDR_OFFSET(i)]));
-            }
-        }
+    uint32_t record = FEE_BANK_ADDRESS(ActiveBank) + FEE_LOG_OFFSET + LogRecords * FEE_LOG_RECORD_SIZE;
+    LogRecords++;
+    FlashStatus = FLASH_ProgramHalfWord(record, Address);
+    if (FlashStatus == FLASH_COMPLETE) {
+        FlashStatus = FLASH_ProgramHalfWord(record + 2, DataByte | (uint8_t)~DataByte << 8);
     }
     return FlashStatus;
 }
@@ -108,8 +214,9 @@ uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
 uint8_t EEPROM_ReadDataByte(uint16_t Address) {
     uint8_t DataByte = 0xFF;
 
-    // Get Byte from specified address
-    DataByte = (*(__IO uint8_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address)));
+    if (Address < FEE_DENSITY_BYTES) {
+        DataByte = DataBuf[Address];
+    }
 
     return DataByte;
 }
@@ -118,44 +225,44 @@ uint8_t EEPROM_ReadDataByte(uint16_t Address) {
  *  Wrap library in AVR style functions.
  *******************************************************************************/
 uint8_t eeprom_read_byte(const uint8_t *Address) {
-    const uint16_t p = (const uint32_t)Address;
+    const uint16_t p = (uintptr_t)Address;
     return EEPROM_ReadDataByte(p);
 }
 
 void eeprom_write_byte(uint8_t *Address, uint8_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, Value);
 }
 
 void eeprom_update_byte(uint8_t *Address, uint8_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, Value);
 }
 
 uint16_t eeprom_read_word(const uint16_t *Address) {
-    const uint16_t p = (const uint32_t)Address;
+    const uint16_t p = (uintptr_t)Address;
     return EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8);
 }
 
 void eeprom_write_word(uint16_t *Address, uint16_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, (uint8_t)Value);
     EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
 }
 
 void eeprom_update_word(uint16_t *Address, uint16_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, (uint8_t)Value);
     EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
 }
 
 uint32_t eeprom_read_dword(const uint32_t *Address) {
-    const uint16_t p = (const uint32_t)Address;
+    const uint16_t p = (uintptr_t)Address;
     return EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8) | (EEPROM_ReadDataByte(p + 2) << 16) | (EEPROM_ReadDataByte(p + 3) << 24);
 }
 
 void eeprom_write_dword(uint32_t *Address, uint32_t Value) {
-    uint16_t p = (const uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, (uint8_t)Value);
     EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
     EEPROM_WriteDataByte(p + 2, (uint8_t)(Value >> 16));
@@ -163,7 +270,7 @@ void eeprom_write_dword(uint32_t *Address, uint32_t Value) {
 }
 
 void eeprom_update_dword(uint32_t *Address, uint32_t Value) {
-    uint16_t p             = (const uint32_t)Address;
+    uint16_t p             = (uintptr_t)Address;
     uint32_t existingValue = EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8) | (EEPROM_ReadDataByte(p + 2) << 16) | (EEPROM_ReadDataByte(p + 3) << 24);
     if (Value != existingValue) {
         EEPROM_WriteDataByte(p, (uint8_t)Value);
@@ -17,15 +17,17 @@
  *
  * This library assumes 8-bit data locations. To add a new MCU, please provide the flash
  * page size and the total flash size in Kb. The number of available pages must be a multiple
- * of 2. Only half of the pages account for the total EEPROM size.
+ * of 2: the pages are split into two banks, and only one of them is live at a time.
  * This library also assumes that the pages are not used by the firmware.
  */
 
 #ifndef __EEPROM_H
 #define __EEPROM_H
 
-#include "ch.h"
-#include "hal.h"
+#ifndef FLASH_STM32_MOCKED
+#    include "ch.h"
+#    include "hal.h"
+#endif
 #include "flash_stm32.h"
 
 // HACK ALERT. This definition may not match your processor
@@ -43,10 +45,12 @@
 #ifndef EEPROM_PAGE_SIZE
 #    if defined(MCU_STM32F103RB)
 #        define FEE_PAGE_SIZE (uint16_t)0x400  // Page size = 1KByte
-#        define FEE_DENSITY_PAGES 2            // How many pages are used
+#        define FEE_DENSITY_PAGES 4            // How many pages are used
+#        define FEE_LEGACY_PAGES 2             // How many pages the old layout used
 #    elif defined(MCU_STM32F103ZE) || defined(MCU_STM32F103RE) || defined(MCU_STM32F103RD) || defined(MCU_STM32F303CC) || defined(MCU_STM32F072CB)
 #        define FEE_PAGE_SIZE (uint16_t)0x800  // Page size = 2KByte
 #        define FEE_DENSITY_PAGES 4            // How many pages are used
+#        define FEE_LEGACY_PAGES 4             // How many pages the old layout used
 #    else
 #        error "No MCU type specified. Add something like -DMCU_STM32F103RB to your compiler arguments (probably in a Makefile)."
 #    endif
@@ -69,10 +73,52 @@
 // DONT CHANGE
 // Choose location for the first EEPROM Page address on the top of flash
 #define FEE_PAGE_BASE_ADDRESS ((uint32_t)(0x8000000 + FEE_MCU_FLASH_SIZE * 1024 - FEE_DENSITY_PAGES * FEE_PAGE_SIZE))
-#define FEE_DENSITY_BYTES ((FEE_PAGE_SIZE / 2) * FEE_DENSITY_PAGES - 1)
 #define FEE_LAST_PAGE_ADDRESS (FEE_PAGE_BASE_ADDRESS + (FEE_PAGE_SIZE * FEE_DENSITY_PAGES))
 #define FEE_EMPTY_WORD ((uint16_t)0xFFFF)
-#define FEE_ADDR_OFFSET(Address) (Address * 2)  // 1Byte per Word will be saved to preserve Flash
+
+/* Each bank holds a header, a full copy of the EEPROM taken at the last
+ * compaction, and a log of the bytes written since then. Writes append one
+ * (address, value) record to the log; only a full log triggers a compaction
+ * into the other bank, which is the only time pages are erased.
+ */
+#define FEE_BANK_PAGES (FEE_DENSITY_PAGES / 2)
+#define FEE_BANK_SIZE ((uint32_t)FEE_PAGE_SIZE * FEE_BANK_PAGES)
+#define FEE_BANK_ADDRESS(Bank) (FEE_PAGE_BASE_ADDRESS + (Bank)*FEE_BANK_SIZE)
+#define FEE_HEADER_SIZE 4
+#define FEE_BANK_MAGIC ((uint16_t)0xEE5A)
+
+// Number of emulated EEPROM bytes; the rest of each bank is log space
+#ifndef FEE_DENSITY_BYTES
+#    define FEE_DENSITY_BYTES (FEE_BANK_SIZE / 2)
+#endif
+#define FEE_LOG_OFFSET (FEE_HEADER_SIZE + FEE_DENSITY_BYTES)
+#define FEE_LOG_RECORD_SIZE 4
+#define FEE_LOG_RECORDS ((FEE_BANK_SIZE - FEE_LOG_OFFSET) / FEE_LOG_RECORD_SIZE)
+
+/* The layout before the log kept byte n in the low half of the half-word at
+ * 2n, from the start of the FEE_LEGACY_PAGES at the top of flash.
+ */
+#ifndef FEE_LEGACY_PAGES
+#    define FEE_LEGACY_PAGES FEE_DENSITY_PAGES
+#endif
+#define FEE_LEGACY_ADDRESS (FEE_LAST_PAGE_ADDRESS - FEE_LEGACY_PAGES * FEE_PAGE_SIZE)
+#define FEE_LEGACY_BYTES ((FEE_PAGE_SIZE / 2) * FEE_LEGACY_PAGES)
+#define FEE_LEGACY_BANK ((FEE_LEGACY_ADDRESS - FEE_PAGE_BASE_ADDRESS) / FEE_BANK_SIZE)
+
+#if FEE_DENSITY_PAGES < 2 || FEE_DENSITY_PAGES % 2 != 0
+#    error "FEE_DENSITY_PAGES must be an even number of pages"
+#endif
+
+#ifdef FLASH_STM32_MOCKED
+// Host builds keep the emulated flash pages in RAM, see tmk_core/common/test/flash_stm32.c
+extern uint8_t  FlashBuf[FEE_DENSITY_PAGES * FEE_PAGE_SIZE];
+extern uint32_t FlashEraseCount[FEE_DENSITY_PAGES];
+extern uint32_t FlashProgramCount;
+extern int32_t  FlashFailAfter;
+#    define FEE_FLASH(Address) ((const uint8_t *)&FlashBuf[(Address)-FEE_PAGE_BASE_ADDRESS])
+#else
+#    define FEE_FLASH(Address) ((const uint8_t *)(Address))
+#endif
 
 // Use this function to initialize the functionality
 uint16_t EEPROM_Init(void);
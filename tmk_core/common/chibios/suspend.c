@@ -15,6 +15,10 @@
 #    include "backlight.h"
 #endif
 
+#ifdef EEPROM_CACHE_ENABLE
+#    include "eeprom.h"
+#endif
+
 #if defined(RGBLIGHT_SLEEP) && defined(RGBLIGHT_ENABLE)
 #    include "rgblight.h"
 extern rgblight_config_t rgblight_config;
@@ -58,6 +62,9 @@ void suspend_power_down(void) {
         rgblight_disable_noeeprom();
     }
 #endif
+#ifdef EEPROM_CACHE_ENABLE
+    eeprom_cache_flush();
+#endif
 
     suspend_power_down_kb();
     // on AVR, this enables the watchdog for 15ms (max), and goes to
@@ -82,6 +89,66 @@ bool                       suspend_wakeup_condition(void) {
     return false;
 }
 
+#ifdef MATRIX_IDLE_TIMEOUT
+#    if !PAL_USE_CALLBACKS
+#        error "MATRIX_IDLE_TIMEOUT needs PAL_USE_CALLBACKS set to TRUE in halconf.h"
+#    endif
+
+static BSEMAPHORE_DECL(idle_wake_sem, true);
+// Armed lines by pad number, as an EXTI channel serves a single port at a time
+static ioline_t idle_wake_lines[16];
+static uint16_t idle_wake_pads;
+
+static void idle_wake_cb(void *arg) {
+    (void)arg;
+    chSysLockFromISR();
+    chBSemSignalI(&idle_wake_sem);
+    chSysUnlockFromISR();
+}
+
+/** \brief Wake suspend_idle_sleep() as soon as this line falls
+ *
+ * Returns false when another port already holds the EXTI channel of this pad
+ * number, that line is then only polled.
+ */
+bool suspend_idle_wake_line(ioline_t line) {
+    uint8_t pad = PAL_PAD(line);
+
+    if (idle_wake_pads & (1U << pad)) {
+        return false;
+    }
+    idle_wake_pads |= 1U << pad;
+    idle_wake_lines[pad] = line;
+    palEnableLineEvent(line, PAL_EVENT_MODE_FALLING_EDGE);
+    palSetLineCallback(line, idle_wake_cb, NULL);
+    return true;
+}
+
+/** \brief Disarm every line armed with suspend_idle_wake_line()
+ */
+void suspend_idle_wake_clear(void) {
+    for (uint8_t pad = 0; pad < 16; pad++) {
+        if (idle_wake_pads & (1U << pad)) {
+            palDisableLineEvent(idle_wake_lines[pad]);
+        }
+    }
+    idle_wake_pads = 0;
+    chBSemReset(&idle_wake_sem, true);
+}
+
+/** \brief Sleep until a key may have been pressed
+ *
+ * Expects the matrix to be armed with matrix_wake_arm(). Blocks the thread,
+ * so the MCU waits for interrupts, until an armed sense line falls. Returns
+ * after 15ms at the latest so the other tasks and any lines that could not be
+ * armed are still polled.
+ */
+bool suspend_idle_sleep(void) {
+    chBSemWaitTimeout(&idle_wake_sem, TIME_MS2I(15));
+    return true;
+}
+#endif
+
 /** \brief run user level code immediately after wakeup
  *
  * FIXME: needs doc
@@ -38,11 +38,16 @@ void eeconfig_init_quantum(void) {
 #endif
 #if defined(EEPROM_DRIVER)
     eeprom_driver_erase();
+#endif
+#if defined(EEPROM_CACHE_ENABLE) && (defined(STM32_EEPROM_ENABLE) || defined(EEPROM_DRIVER))
+    eeprom_cache_invalidate();
 #endif
     eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
     eeprom_update_byte(EECONFIG_DEBUG, 0);
     eeprom_update_byte(EECONFIG_DEFAULT_LAYER, 0);
     default_layer_state = 0;
+    // default_layer_state_set() would run the keymap's hooks this early
+    layer_lookup_cache_clear();
     eeprom_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, 0);
     eeprom_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, 0);
     eeprom_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
@@ -90,6 +95,9 @@ void eeconfig_disable(void) {
 #endif
 #if defined(EEPROM_DRIVER)
     eeprom_driver_erase();
+#endif
+#if defined(EEPROM_CACHE_ENABLE) && (defined(STM32_EEPROM_ENABLE) || defined(EEPROM_DRIVER))
+    eeprom_cache_invalidate();
 #endif
     eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER_OFF);
 }
@@ -21,4 +21,8 @@ void     eeprom_update_dword(uint32_t *__p, uint32_t __value);
 void     eeprom_update_block(const void *__src, void *__dst, size_t __n);
 #endif
 
+#ifdef EEPROM_CACHE_ENABLE
+#    include "eeprom_cache.h"
+#endif
+
 #endif /* TMK_CORE_COMMON_EEPROM_H_ */
@@ -0,0 +1,164 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#define EEPROM_CACHE_BACKEND
+#include "eeprom.h"
+#include "eeprom_cache.h"
+#include "eeconfig.h"
+#include "timer.h"
+#ifdef DYNAMIC_KEYMAP_ENABLE
+#    include "dynamic_keymap.h"
+#endif
+
+/* By default the cache covers eeconfig, plus VIA and the dynamic keymaps
+ * where there is RAM to spare. Dynamic keymap macros are left out, as they
+ * are large and rarely written.
+ */
+#ifndef EEPROM_CACHE_SIZE
+#    if defined(DYNAMIC_KEYMAP_ENABLE) && !defined(__AVR__)
+#        define EEPROM_CACHE_SIZE DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR
+#    else
+#        define EEPROM_CACHE_SIZE EECONFIG_SIZE
+#    endif
+#endif
+
+static uint8_t  cache[EEPROM_CACHE_SIZE];
+static uint8_t  dirty[(EEPROM_CACHE_SIZE + 7) / 8];
+static bool     loaded;
+static bool     any_dirty;
+static uint16_t last_write;
+
+static void cache_load(void) {
+    if (!loaded) {
+        eeprom_read_block(cache, (const void *)0, EEPROM_CACHE_SIZE);
+        loaded = true;
+    }
+}
+
+static void cache_read(void *buf, uintptr_t addr, size_t len) {
+    uint8_t *dest = (uint8_t *)buf;
+
+    if (addr < EEPROM_CACHE_SIZE) {
+        size_t cached = EEPROM_CACHE_SIZE - addr;
+        if (cached > len) {
+            cached = len;
+        }
+        cache_load();
+        memcpy(dest, &cache[addr], cached);
+        dest += cached;
+        addr += cached;
+        len -= cached;
+    }
+    if (len) {
+        eeprom_read_block(dest, (const void *)addr, len);
+    }
+}
+
+static void cache_write(const void *buf, uintptr_t addr, size_t len) {
+    const uint8_t *src = (const uint8_t *)buf;
+
+    if (addr < EEPROM_CACHE_SIZE) {
+        cache_load();
+        for (; len && addr < EEPROM_CACHE_SIZE; len--, addr++, src++) {
+            if (cache[addr] != *src) {
+                cache[addr] = *src;
+                dirty[addr / 8] |= 1 << (addr % 8);
+                any_dirty = true;
+            }
+        }
+        last_write = timer_read();
+    }
+    if (len) {
+        eeprom_update_block(src, (void *)addr, len);
+    }
+}
+
+uint8_t eeprom_cache_read_byte(const uint8_t *addr) {
+    uint8_t value;
+    cache_read(&value, (uintptr_t)addr, sizeof(value));
+    return value;
+}
+
+uint16_t eeprom_cache_read_word(const uint16_t *addr) {
+    uint16_t value;
+    cache_read(&value, (uintptr_t)addr, sizeof(value));
+    return value;
+}
+
+uint32_t eeprom_cache_read_dword(const uint32_t *addr) {
+    uint32_t value;
+    cache_read(&value, (uintptr_t)addr, sizeof(value));
+    return value;
+}
+
+void eeprom_cache_read_block(void *buf, const void *addr, size_t len) { cache_read(buf, (uintptr_t)addr, len); }
+
+void eeprom_cache_update_byte(uint8_t *addr, uint8_t value) { cache_write(&value, (uintptr_t)addr, sizeof(value)); }
+
+void eeprom_cache_update_word(uint16_t *addr, uint16_t value) { cache_write(&value, (uintptr_t)addr, sizeof(value)); }
+
+void eeprom_cache_update_dword(uint32_t *addr, uint32_t value) { cache_write(&value, (uintptr_t)addr, sizeof(value)); }
+
+void eeprom_cache_update_block(const void *buf, void *addr, size_t len) { cache_write(buf, (uintptr_t)addr, len); }
+
+bool eeprom_cache_is_dirty(void) { return any_dirty; }
+
+/* Commits every run of dirty bytes with a single block update, so drivers
+ * that work in pages or emulate EEPROM in flash see as few writes as possible.
+ */
+void eeprom_cache_flush(void) {
+    if (!any_dirty) {
+        return;
+    }
+
+    uint16_t addr = 0;
+    while (addr < EEPROM_CACHE_SIZE) {
+        if (!dirty[addr / 8]) {
+            addr = (addr / 8 + 1) * 8;
+            continue;
+        }
+        if (!(dirty[addr / 8] & (1 << (addr % 8)))) {
+            addr++;
+            continue;
+        }
+
+        uint16_t end = addr;
+        while (end < EEPROM_CACHE_SIZE && (dirty[end / 8] & (1 << (end % 8)))) {
+            end++;
+        }
+        eeprom_update_block(&cache[addr], (void *)(uintptr_t)addr, end - addr);
+        addr = end;
+    }
+
+    memset(dirty, 0, sizeof(dirty));
+    any_dirty = false;
+}
+
+/* Drops everything in RAM, including changes not committed yet. Needed after
+ * the driver has been erased behind the cache's back.
+ */
+void eeprom_cache_invalidate(void) {
+    memset(dirty, 0, sizeof(dirty));
+    any_dirty = false;
+    loaded    = false;
+}
+
+void eeprom_cache_task(void) {
+    if (any_dirty && timer_elapsed(last_write) >= EEPROM_CACHE_COMMIT_DELAY) {
+        eeprom_cache_flush();
+    }
+}
@@ -0,0 +1,67 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Write-back cache over the start of the EEPROM, where eeconfig and the
+ * dynamic keymaps live. Reads and writes below EEPROM_CACHE_SIZE only touch
+ * RAM; dirty bytes are committed to the EEPROM driver once no write has
+ * happened for EEPROM_CACHE_COMMIT_DELAY ms, on suspend, before jumping to
+ * the bootloader, or when eeprom_cache_flush() is called. Accesses past the
+ * cached region go straight to the driver.
+ */
+
+// Idle time after the last write before dirty bytes are committed, in ms
+#ifndef EEPROM_CACHE_COMMIT_DELAY
+#    define EEPROM_CACHE_COMMIT_DELAY 2000
+#endif
+
+uint8_t  eeprom_cache_read_byte(const uint8_t *addr);
+uint16_t eeprom_cache_read_word(const uint16_t *addr);
+uint32_t eeprom_cache_read_dword(const uint32_t *addr);
+void     eeprom_cache_read_block(void *buf, const void *addr, size_t len);
+void     eeprom_cache_update_byte(uint8_t *addr, uint8_t value);
+void     eeprom_cache_update_word(uint16_t *addr, uint16_t value);
+void     eeprom_cache_update_dword(uint32_t *addr, uint32_t value);
+void     eeprom_cache_update_block(const void *buf, void *addr, size_t len);
+
+bool eeprom_cache_is_dirty(void);
+void eeprom_cache_flush(void);
+void eeprom_cache_invalidate(void);
+void eeprom_cache_task(void);
+
+/* Everything that includes eeprom.h goes through the cache. Drivers define
+ * EEPROM_CACHE_BACKEND before including it to get the real functions, and
+ * (eeprom_read_byte)(addr) style calls also bypass the cache.
+ */
+#ifndef EEPROM_CACHE_BACKEND
+#    define eeprom_read_byte(addr) eeprom_cache_read_byte(addr)
+#    define eeprom_read_word(addr) eeprom_cache_read_word(addr)
+#    define eeprom_read_dword(addr) eeprom_cache_read_dword(addr)
+#    define eeprom_read_block(buf, addr, len) eeprom_cache_read_block(buf, addr, len)
+#    define eeprom_write_byte(addr, value) eeprom_cache_update_byte(addr, value)
+#    define eeprom_write_word(addr, value) eeprom_cache_update_word(addr, value)
+#    define eeprom_write_dword(addr, value) eeprom_cache_update_dword(addr, value)
+#    define eeprom_write_block(buf, addr, len) eeprom_cache_update_block(buf, addr, len)
+#    define eeprom_update_byte(addr, value) eeprom_cache_update_byte(addr, value)
+#    define eeprom_update_word(addr, value) eeprom_cache_update_word(addr, value)
+#    define eeprom_update_dword(addr, value) eeprom_cache_update_dword(addr, value)
+#    define eeprom_update_block(buf, addr, len) eeprom_cache_update_block(buf, addr, len)
+#endif
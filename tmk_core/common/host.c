@@ -21,6 +21,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#include "scan_profile.h"
+#include "keyboard.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -62,7 +64,9 @@ void host_keyboard_send(report_keyboard_t *report) {
         report->report_id = REPORT_ID_KEYBOARD;
 #endif
     }
+    scan_profile_begin(SCAN_PROFILE_USB_SEND);
     (*driver->send_keyboard)(report);
+    scan_profile_end(SCAN_PROFILE_USB_SEND);
 
     if (debug_keyboard) {
         dprint("keyboard_report: ");
@@ -73,7 +77,16 @@ void host_keyboard_send(report_keyboard_t *report) {
     }
 }
 
+/* Keyboard reports the host driver can take without blocking. Drivers that
+ * queue reports override this; the others never report a full queue.
+ */
+__attribute__((weak)) uint8_t host_keyboard_queue_free(void) { return UINT8_MAX; }
+
 void host_mouse_send(report_mouse_t *report) {
+#ifdef MATRIX_IDLE_TIMEOUT
+    // mouse keys, pointing devices and PS/2 or ADB mice all report here
+    matrix_idle_activity();
+#endif
     if (!driver) return;
 #ifdef MOUSE_SHARED_EP
     report->report_id = REPORT_ID_MOUSE;
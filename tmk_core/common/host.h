@@ -48,6 +48,8 @@ void    host_mouse_send(report_mouse_t *report);
 void    host_system_send(uint16_t data);
 void    host_consumer_send(uint16_t data);
 
+uint8_t host_keyboard_queue_free(void);
+
 uint16_t host_last_system_report(void);
 uint16_t host_last_consumer_report(void);
 
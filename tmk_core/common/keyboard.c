@@ -30,6 +30,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "scan_profile.h"
+#ifdef QMK_BATCH_KEY_EVENTS
+#    include "action_util.h"
+#endif
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -86,6 +90,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef VIA_ENABLE
 #    include "via.h"
 #endif
+#ifdef EEPROM_CACHE_ENABLE
+#    include "eeprom.h"
+#endif
+#ifdef MATRIX_IDLE_TIMEOUT
+#    include "suspend.h"
+#endif
+#ifdef SEND_STRING_ASYNC_ENABLE
+#    include "send_string_async.h"
+#endif
 
 // Only enable this if console is enabled to print to
 #if defined(DEBUG_MATRIX_SCAN_RATE) && defined(CONSOLE_ENABLE)
@@ -265,6 +278,90 @@ void keyboard_init(void) {
     keyboard_post_init_kb(); /* Always keep this last */
 }
 
+#ifdef MATRIX_IDLE_TIMEOUT
+#    ifdef SPLIT_KEYBOARD
+#        error MATRIX_IDLE_TIMEOUT is not supported on split keyboards
+#    endif
+#    ifndef MATRIX_IDLE_WAKE_WINDOW
+#        define MATRIX_IDLE_WAKE_WINDOW 50
+#    endif
+
+static uint32_t idle_activity_time;
+static uint16_t idle_wake_time;
+static bool     idle_wake_pending;
+
+__attribute__((weak)) void matrix_wake_arm(void) {}
+__attribute__((weak)) void matrix_wake_disarm(void) {}
+__attribute__((weak)) bool matrix_wake_check(void) {
+    matrix_scan();
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        if (matrix_get_row(r)) return true;
+    }
+    return false;
+}
+
+void matrix_idle_activity(void) { idle_activity_time = timer_read32(); }
+
+/** \brief Sleep while the matrix is idle
+ *
+ * Once no key has been down for MATRIX_IDLE_TIMEOUT ms, each call arms the
+ * matrix and lets the platform sleep until a key may have gone down.
+ * Returns true while the keyboard stays idle, in which case there is no
+ * matrix to scan; the other tasks still run after each sleep.
+ */
+static bool matrix_idle_task(void) {
+#    ifdef SEND_STRING_ASYNC_ENABLE
+    if (send_string_async_busy()) {
+        // queued output is sent from the matrix scan
+        idle_activity_time = timer_read32();
+    }
+#    endif
+    if (timer_elapsed32(idle_activity_time) < MATRIX_IDLE_TIMEOUT) {
+        return false;
+    }
+
+#    ifdef EEPROM_CACHE_ENABLE
+    eeprom_cache_flush();
+#    endif
+    matrix_wake_arm();
+    bool slept    = suspend_idle_sleep();
+    bool key_down = matrix_wake_check();
+    matrix_wake_disarm();
+
+    if (!slept) {
+        // the platform can't sleep right now, try again after another timeout
+        idle_activity_time = timer_read32();
+        return false;
+    }
+    if (key_down) {
+        // the key only reaches the keymap after debouncing, remember when it went down
+        idle_activity_time = timer_read32();
+        idle_wake_time     = timer_read() | 1; /* time should not be 0 */
+        idle_wake_pending  = true;
+        return false;
+    }
+    return true;
+}
+#endif
+
+/** \brief Timestamp for a key event found by the current scan
+ *
+ * The first event after waking from idle gets the time of the wake-up.
+ */
+static uint16_t key_event_time(void) {
+    uint16_t time = timer_read() | 1; /* time should not be 0 */
+#ifdef MATRIX_IDLE_TIMEOUT
+    if (idle_wake_pending) {
+        idle_wake_pending = false;
+        // a wake-up that debouncing filtered out must not date a later press
+        if (TIMER_DIFF_16(time, idle_wake_time) < MATRIX_IDLE_WAKE_WINDOW) {
+            return idle_wake_time;
+        }
+    }
+#endif
+    return time;
+}
+
 /** \brief Keyboard task: Do keyboard routine jobs
  *
  * Do routine keyboard jobs:
@@ -282,20 +379,47 @@ void keyboard_task(void) {
     static uint8_t      led_status    = 0;
     matrix_row_t        matrix_row    = 0;
     matrix_row_t        matrix_change = 0;
-#ifdef QMK_KEYS_PER_SCAN
+#if defined(QMK_KEYS_PER_SCAN) || defined(QMK_BATCH_KEY_EVENTS)
     uint8_t keys_processed = 0;
 #endif
+#if defined(OLED_DRIVER_ENABLE) && !defined(OLED_DISABLE_TIMEOUT)
+    uint8_t ret = 0;
+#endif
+
+#ifdef MATRIX_IDLE_TIMEOUT
+    bool idle = matrix_idle_task();
+#endif
 
+    scan_profile_begin(SCAN_PROFILE_KEYBOARD_TASK);
+#ifdef MATRIX_IDLE_TIMEOUT
+    if (idle) {
+        // only the matrix sleeps, encoders and the per scan hooks still run
+        matrix_scan_quantum();
+        goto MATRIX_IDLE_END;
+    }
+#endif
+    scan_profile_begin(SCAN_PROFILE_MATRIX_SCAN);
 #if defined(OLED_DRIVER_ENABLE) && !defined(OLED_DISABLE_TIMEOUT)
-    uint8_t ret = matrix_scan();
+    ret = matrix_scan();
 #else
     matrix_scan();
 #endif
+    scan_profile_end(SCAN_PROFILE_MATRIX_SCAN);
 
     if (is_keyboard_master()) {
+#ifdef QMK_BATCH_KEY_EVENTS
+        // every change found in this scan shares its timestamp and its report
+        uint16_t scan_time = 0;
+        keyboard_report_batch_start();
+#endif
         for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
             matrix_row    = matrix_get_row(r);
             matrix_change = matrix_row ^ matrix_prev[r];
+#ifdef MATRIX_IDLE_TIMEOUT
+            if (matrix_row || matrix_change) {
+                idle_activity_time = timer_read32();
+            }
+#endif
             if (matrix_change) {
 #ifdef MATRIX_HAS_GHOST
                 if (has_ghost_in_row(r, matrix_row)) {
@@ -306,37 +430,63 @@ void keyboard_task(void) {
                 matrix_row_t col_mask = 1;
                 for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
                     if (matrix_change & col_mask) {
-                        action_exec((keyevent_t){
-                            .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = (timer_read() | 1) /* time should not be 0 */
-                        });
+#ifdef QMK_BATCH_KEY_EVENTS
+                        if (!scan_time) {
+                            scan_time = key_event_time();
+                        }
+                        scan_profile_begin(SCAN_PROFILE_ACTION_EXEC);
+                        action_exec((keyevent_t){.key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = scan_time});
+                        scan_profile_end(SCAN_PROFILE_ACTION_EXEC);
+                        // record a processed key, and keep going until the whole matrix is consumed
+                        matrix_prev[r] ^= col_mask;
+                        keys_processed++;
+#else
+                        scan_profile_begin(SCAN_PROFILE_ACTION_EXEC);
+                        action_exec((keyevent_t){.key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = key_event_time()});
+                        scan_profile_end(SCAN_PROFILE_ACTION_EXEC);
                         // record a processed key
                         matrix_prev[r] ^= col_mask;
-#ifdef QMK_KEYS_PER_SCAN
+#    ifdef QMK_KEYS_PER_SCAN
                         // only jump out if we have processed "enough" keys.
                         if (++keys_processed >= QMK_KEYS_PER_SCAN)
-#endif
+#    endif
                             // process a key per task call
                             goto MATRIX_LOOP_END;
+#endif
                     }
                 }
             }
         }
     }
     // call with pseudo tick event when no real key event.
-#ifdef QMK_KEYS_PER_SCAN
+#if defined(QMK_KEYS_PER_SCAN) || defined(QMK_BATCH_KEY_EVENTS)
     // we can get here with some keys processed now.
     if (!keys_processed)
 #endif
+    {
+        scan_profile_begin(SCAN_PROFILE_ACTION_EXEC);
         action_exec(TICK);
+        scan_profile_end(SCAN_PROFILE_ACTION_EXEC);
+    }
 
+#ifdef QMK_BATCH_KEY_EVENTS
+    // send the state the whole scan produced as a single report
+    keyboard_report_batch_flush();
+#else
 MATRIX_LOOP_END:
+#endif
+#ifdef MATRIX_IDLE_TIMEOUT
+MATRIX_IDLE_END:
+#endif
 
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_scan_perf_task();
 #endif
 
 #if defined(RGBLIGHT_ENABLE)
+    scan_profile_begin(SCAN_PROFILE_RGBLIGHT);
     rgblight_task();
+    scan_profile_end(SCAN_PROFILE_RGBLIGHT);
 #endif
 
 #if defined(BACKLIGHT_ENABLE)
@@ -350,7 +500,9 @@ MATRIX_LOOP_END:
 #endif
 
 #ifdef OLED_DRIVER_ENABLE
+    scan_profile_begin(SCAN_PROFILE_OLED);
     oled_task();
+    scan_profile_end(SCAN_PROFILE_OLED);
 #    ifndef OLED_DISABLE_TIMEOUT
     // Wake up oled if user is using those fabulous keys!
     if (ret) oled_on();
@@ -359,7 +511,9 @@ MATRIX_LOOP_END:
 
 #ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
+    scan_profile_begin(SCAN_PROFILE_MOUSEKEY);
     mousekey_task();
+    scan_profile_end(SCAN_PROFILE_MOUSEKEY);
 #endif
 
 #ifdef PS2_MOUSE_ENABLE
@@ -383,11 +537,15 @@ MATRIX_LOOP_END:
 #endif
 
 #ifdef POINTING_DEVICE_ENABLE
+    scan_profile_begin(SCAN_PROFILE_POINTING_DEVICE);
     pointing_device_task();
+    scan_profile_end(SCAN_PROFILE_POINTING_DEVICE);
 #endif
 
 #ifdef MIDI_ENABLE
+    scan_profile_begin(SCAN_PROFILE_MIDI);
     midi_task();
+    scan_profile_end(SCAN_PROFILE_MIDI);
 #endif
 
 #ifdef VELOCIKEY_ENABLE
@@ -396,11 +554,18 @@ MATRIX_LOOP_END:
     }
 #endif
 
+#ifdef EEPROM_CACHE_ENABLE
+    eeprom_cache_task();
+#endif
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
         keyboard_set_leds(led_status);
     }
+
+    scan_profile_end(SCAN_PROFILE_KEYBOARD_TASK);
+    scan_profile_task();
 }
 
 /** \brief keyboard set leds
@@ -63,6 +63,10 @@ void keyboard_task(void);
 void keyboard_set_leds(uint8_t leds);
 /* it runs whenever code has to behave differently on a slave */
 bool is_keyboard_master(void);
+#ifdef MATRIX_IDLE_TIMEOUT
+/* marks input from outside the key matrix (encoders, mice), which keeps the keyboard from going idle */
+void matrix_idle_activity(void);
+#endif
 
 void keyboard_pre_init_kb(void);
 void keyboard_pre_init_user(void);
@@ -73,6 +73,13 @@ void matrix_io_delay(void);
 void matrix_power_up(void);
 void matrix_power_down(void);
 
+/* low-power idle: hold all rows active so that any keypress can be sensed */
+void matrix_wake_arm(void);
+/* whether any key is down while armed */
+bool matrix_wake_check(void);
+/* return the pins to their scanning state */
+void matrix_wake_disarm(void);
+
 /* executes code for Quantum */
 void matrix_init_quantum(void);
 void matrix_scan_quantum(void);
@@ -0,0 +1,151 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "scan_profile.h"
+#include "timer.h"
+#include "print.h"
+#include "debug.h"
+
+#if defined(__AVR__)
+#    include <avr/io.h>
+#    include <util/atomic.h>
+
+// timer0 ticks TIMER_RAW_TOP times per ms
+static uint32_t scan_profile_ticks(void) {
+    uint32_t ms;
+    uint8_t  raw;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms  = timer_count;
+        raw = TIMER_RAW;
+#    if defined(TIFR0) && defined(OCF0A)
+        // the counter wrapped but the compare interrupt has not run yet
+        if ((TIFR0 & _BV(OCF0A)) && raw < TIMER_RAW_TOP / 2) {
+            ms++;
+        }
+#    endif
+    }
+    return ms * TIMER_RAW_TOP + raw;
+}
+#    define SCAN_PROFILE_TICKS_TO_US(ticks) ((ticks)*1000UL / TIMER_RAW_TOP)
+#elif defined(PROTOCOL_CHIBIOS)
+#    include "ch.h"
+
+#    if PORT_SUPPORTS_RT && defined(STM32_SYSCLK)
+// cycle counter, converted to us after taking the difference so that wrapping is harmless
+#        define scan_profile_ticks() ((uint32_t)chSysGetRealtimeCounterX())
+#        define SCAN_PROFILE_TICKS_TO_US(ticks) RTC2US(STM32_SYSCLK, ticks)
+#    else
+#        define scan_profile_ticks() ((uint32_t)chVTGetSystemTimeX())
+#        define SCAN_PROFILE_TICKS_TO_US(ticks) TIME_I2US(ticks)
+#    endif
+#else
+#    define scan_profile_ticks() timer_read32()
+#    define SCAN_PROFILE_TICKS_TO_US(ticks) ((ticks)*1000UL)
+#endif
+
+static scan_profile_histogram_t histograms[SCAN_PROFILE_SECTION_COUNT];
+static uint32_t                 section_start[SCAN_PROFILE_SECTION_COUNT];
+
+/** \brief Start timing a section of the scan loop
+ */
+void scan_profile_begin(scan_profile_section_t section) { section_start[section] = scan_profile_ticks(); }
+
+/** \brief Stop timing a section, and add its duration to the section's histogram
+ */
+void scan_profile_end(scan_profile_section_t section) {
+    uint32_t ticks = scan_profile_ticks() - section_start[section];
+    scan_profile_record(section, SCAN_PROFILE_TICKS_TO_US(ticks));
+}
+
+/** \brief Add a duration, in us, to a section's histogram
+ */
+void scan_profile_record(scan_profile_section_t section, uint32_t us) {
+    scan_profile_histogram_t *histogram = &histograms[section];
+
+    uint8_t bucket = 0;
+    for (uint32_t remaining = us; remaining && bucket < SCAN_PROFILE_BUCKETS - 1; remaining >>= 1) {
+        bucket++;
+    }
+    if (histogram->buckets[bucket] < UINT16_MAX) {
+        histogram->buckets[bucket]++;
+    }
+    if (us > histogram->max_us) {
+        histogram->max_us = us > UINT16_MAX ? UINT16_MAX : us;
+    }
+}
+
+void scan_profile_reset(void) { memset(histograms, 0, sizeof(histograms)); }
+
+const scan_profile_histogram_t *scan_profile_get(scan_profile_section_t section) { return &histograms[section]; }
+
+/** \brief Answer a raw HID profiling request in place
+ *
+ * Request: { SCAN_PROFILE_RAW_HID_ID, section }, or { SCAN_PROFILE_RAW_HID_ID, 0xFF } to clear all histograms.
+ * Reply: { SCAN_PROFILE_RAW_HID_ID, section, max_us (BE16), bucket counts (BE16)... }, truncated to fit.
+ * Returns false if the report isn't a profiling request, so the caller can handle it instead.
+ * The caller is responsible for sending the reply with raw_hid_send().
+ */
+bool scan_profile_raw_hid_receive(uint8_t *data, uint8_t length) {
+    if (length < 2 || data[0] != SCAN_PROFILE_RAW_HID_ID) {
+        return false;
+    }
+    uint8_t section = data[1];
+    if (section == 0xFF) {
+        scan_profile_reset();
+        return true;
+    }
+    memset(&data[2], 0, length - 2);
+    if (section >= SCAN_PROFILE_SECTION_COUNT) {
+        return true;
+    }
+
+    const scan_profile_histogram_t *histogram = &histograms[section];
+
+    uint8_t i = 2;
+    if (i + 2 <= length) {
+        data[i++] = histogram->max_us >> 8;
+        data[i++] = histogram->max_us & 0xFF;
+    }
+    for (uint8_t bucket = 0; bucket < SCAN_PROFILE_BUCKETS && i + 2 <= length; bucket++) {
+        data[i++] = histogram->buckets[bucket] >> 8;
+        data[i++] = histogram->buckets[bucket] & 0xFF;
+    }
+    return true;
+}
+
+/** \brief Periodically dump the histograms to the console
+ */
+void scan_profile_task(void) {
+#ifdef CONSOLE_ENABLE
+    static uint32_t print_timer = 0;
+
+    if (timer_elapsed32(print_timer) < SCAN_PROFILE_PRINT_INTERVAL) {
+        return;
+    }
+    print_timer = timer_read32();
+
+    for (uint8_t section = 0; section < SCAN_PROFILE_SECTION_COUNT; section++) {
+        const scan_profile_histogram_t *histogram = &histograms[section];
+
+        uprintf("scan profile %u: max %uus |", section, histogram->max_us);
+        for (uint8_t bucket = 0; bucket < SCAN_PROFILE_BUCKETS; bucket++) {
+            uprintf(" %u", histogram->buckets[bucket]);
+        }
+        uprintf("\n");
+    }
+#endif
+}
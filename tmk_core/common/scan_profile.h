@@ -0,0 +1,76 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Sections of the scan loop that can be timed.
+ * Sections may nest: ACTION_EXEC includes PROCESS_RECORD_QUANTUM and USB_SEND, MATRIX_SCAN includes DEBOUNCE.
+ */
+typedef enum {
+    SCAN_PROFILE_KEYBOARD_TASK,
+    SCAN_PROFILE_MATRIX_SCAN,
+    SCAN_PROFILE_DEBOUNCE,
+    SCAN_PROFILE_ACTION_EXEC,
+    SCAN_PROFILE_PROCESS_RECORD_QUANTUM,
+    SCAN_PROFILE_USB_SEND,
+    SCAN_PROFILE_RGBLIGHT,
+    SCAN_PROFILE_OLED,
+    SCAN_PROFILE_MOUSEKEY,
+    SCAN_PROFILE_POINTING_DEVICE,
+    SCAN_PROFILE_MIDI,
+    SCAN_PROFILE_SECTION_COUNT,
+} scan_profile_section_t;
+
+#ifndef SCAN_PROFILE_BUCKETS
+#    define SCAN_PROFILE_BUCKETS 12
+#endif
+
+// Raw HID command byte answered by scan_profile_raw_hid_receive()
+#ifndef SCAN_PROFILE_RAW_HID_ID
+#    define SCAN_PROFILE_RAW_HID_ID 0xFD
+#endif
+
+// How often the histograms are dumped to the console, in ms
+#ifndef SCAN_PROFILE_PRINT_INTERVAL
+#    define SCAN_PROFILE_PRINT_INTERVAL 10000
+#endif
+
+/* Bucket 0 counts durations under 1us, bucket n counts durations of [2^(n-1), 2^n) us,
+ * and the last bucket also counts everything longer. Counters saturate instead of wrapping.
+ */
+typedef struct {
+    uint16_t buckets[SCAN_PROFILE_BUCKETS];
+    uint16_t max_us;
+} scan_profile_histogram_t;
+
+#ifdef SCAN_PROFILE_ENABLE
+void scan_profile_begin(scan_profile_section_t section);
+void scan_profile_end(scan_profile_section_t section);
+void scan_profile_record(scan_profile_section_t section, uint32_t us);
+void scan_profile_reset(void);
+void scan_profile_task(void);
+
+const scan_profile_histogram_t *scan_profile_get(scan_profile_section_t section);
+
+bool scan_profile_raw_hid_receive(uint8_t *data, uint8_t length);
+#else
+#    define scan_profile_begin(section)
+#    define scan_profile_end(section)
+#    define scan_profile_task()
+#endif
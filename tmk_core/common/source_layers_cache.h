@@ -0,0 +1,72 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Storage layouts for the source layers cache, which remembers the layer each held key was pressed on.
+ *
+ * BITPLANE: one bit per key in each of `layer_bits` planes. Smallest for 32 layers, but every access loops over the planes.
+ * NIBBLE:   four bits per key, so only layers 0-15. One read-modify-write per access.
+ * BYTE:     one byte per key. Plain loads and stores.
+ */
+#define SOURCE_LAYERS_CACHE_BITPLANE 0
+#define SOURCE_LAYERS_CACHE_NIBBLE 1
+#define SOURCE_LAYERS_CACHE_BYTE 2
+
+#define SOURCE_LAYERS_CACHE_BITPLANE_SIZE(keys, layer_bits) ((((keys) + 7) / 8) * (layer_bits))
+#define SOURCE_LAYERS_CACHE_NIBBLE_SIZE(keys) (((keys) + 1) / 2)
+#define SOURCE_LAYERS_CACHE_BYTE_SIZE(keys) (keys)
+
+static inline void source_layers_cache_bitplane_write(uint8_t *cache, uint8_t layer_bits, uint16_t key_number, uint8_t layer) {
+    uint8_t *     planes      = &cache[(key_number / 8) * layer_bits];
+    const uint8_t storage_bit = key_number % 8;
+
+    for (uint8_t bit_number = 0; bit_number < layer_bits; bit_number++) {
+        planes[bit_number] ^= (-((layer & (1U << bit_number)) != 0) ^ planes[bit_number]) & (1U << storage_bit);
+    }
+}
+
+static inline uint8_t source_layers_cache_bitplane_read(const uint8_t *cache, uint8_t layer_bits, uint16_t key_number) {
+    const uint8_t *planes      = &cache[(key_number / 8) * layer_bits];
+    const uint8_t  storage_bit = key_number % 8;
+    uint8_t        layer       = 0;
+
+    for (uint8_t bit_number = 0; bit_number < layer_bits; bit_number++) {
+        layer |= ((planes[bit_number] & (1U << storage_bit)) != 0) << bit_number;
+    }
+    return layer;
+}
+
+static inline void source_layers_cache_nibble_write(uint8_t *cache, uint16_t key_number, uint8_t layer) {
+    uint8_t *slot = &cache[key_number / 2];
+
+    if (key_number & 1) {
+        *slot = (*slot & 0x0F) | (layer << 4);
+    } else {
+        *slot = (*slot & 0xF0) | (layer & 0x0F);
+    }
+}
+
+static inline uint8_t source_layers_cache_nibble_read(const uint8_t *cache, uint16_t key_number) {
+    uint8_t slot = cache[key_number / 2];
+    return (key_number & 1) ? slot >> 4 : slot & 0x0F;
+}
+
+static inline void source_layers_cache_byte_write(uint8_t *cache, uint16_t key_number, uint8_t layer) { cache[key_number] = layer; }
+
+static inline uint8_t source_layers_cache_byte_read(const uint8_t *cache, uint16_t key_number) { return cache[key_number]; }
@@ -8,6 +8,12 @@ void suspend_idle(uint8_t timeout);
 void suspend_power_down(void);
 bool suspend_wakeup_condition(void);
 void suspend_wakeup_init(void);
+bool suspend_idle_sleep(void);
+#if defined(MATRIX_IDLE_TIMEOUT) && defined(PROTOCOL_CHIBIOS)
+#    include "hal.h"
+bool suspend_idle_wake_line(ioline_t line);
+void suspend_idle_wake_clear(void);
+#endif
 
 void suspend_wakeup_init_user(void);
 void suspend_wakeup_init_kb(void);
@@ -14,9 +14,10 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#define EEPROM_CACHE_BACKEND
 #include "eeprom.h"
 
-#define EEPROM_SIZE 32
+#define EEPROM_SIZE 1024
 
 static uint8_t buffer[EEPROM_SIZE];
 
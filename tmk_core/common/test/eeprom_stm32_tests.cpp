@@ -0,0 +1,241 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "eeprom_stm32.h"
+}
+
+class EepromStm32 : public ::testing::Test {
+   public:
+    EepromStm32() {
+        memset(FlashBuf, 0xFF, sizeof(FlashBuf));
+        memset(FlashEraseCount, 0, sizeof(FlashEraseCount));
+        FlashProgramCount = 0;
+        FlashFailAfter    = -1;
+        EEPROM_Init();
+        shadow.assign(FEE_DENSITY_BYTES, 0xFF);
+    }
+
+    void write(uint16_t address, uint8_t value) {
+        EEPROM_WriteDataByte(address, value);
+        shadow[address] = value;
+    }
+
+    // Simulates a power cycle: the RAM copy is rebuilt from flash alone.
+    void reboot() {
+        FlashFailAfter = -1;
+        EEPROM_Init();
+    }
+
+    // Writes until a write compacts, which leaves an empty log behind.
+    void compact() {
+        for (uint16_t address = 0;; address = (address + 1) % FEE_DENSITY_BYTES) {
+            uint32_t programs = FlashProgramCount;
+            write(address, ~shadow[address]);
+            if (FlashProgramCount - programs != 2) {
+                return;
+            }
+        }
+    }
+
+    // Fills an empty log, so the next write compacts.
+    void fill_log() {
+        for (uint16_t i = 0; i < FEE_LOG_RECORDS; i++) {
+            write(i % 64, ~shadow[i % 64]);
+        }
+    }
+
+    void expect_shadow() {
+        for (uint16_t address = 0; address < FEE_DENSITY_BYTES; address++) {
+            ASSERT_EQ(EEPROM_ReadDataByte(address), shadow[address]) << "address " << address;
+        }
+    }
+
+    uint32_t erases() {
+        uint32_t total = 0;
+        for (auto count : FlashEraseCount) {
+            total += count;
+        }
+        return total;
+    }
+
+    uint32_t max_page_erases() {
+        uint32_t max = 0;
+        for (auto count : FlashEraseCount) {
+            max = std::max(max, count);
+        }
+        return max;
+    }
+
+    std::vector<uint8_t> shadow;
+};
+
+TEST_F(EepromStm32, StartsBlank) {
+    EXPECT_EQ(EEPROM_Init(), FEE_DENSITY_BYTES);
+    expect_shadow();
+}
+
+TEST_F(EepromStm32, KeepsDataAcrossReboots) {
+    write(0, 0x12);
+    write(1, 0x00);
+    write(FEE_DENSITY_BYTES - 1, 0x34);
+    write(0, 0x56);
+    reboot();
+    expect_shadow();
+}
+
+TEST_F(EepromStm32, IgnoresWritesPastTheEnd) {
+    EXPECT_EQ(EEPROM_WriteDataByte(FEE_DENSITY_BYTES, 0x12), 0);
+    EXPECT_EQ(EEPROM_ReadDataByte(FEE_DENSITY_BYTES), 0xFF);
+}
+
+TEST_F(EepromStm32, WritesAreTwoProgramsAndNoErase) {
+    // Get both banks into use, so the next compaction has to erase
+    compact();
+    compact();
+
+    uint32_t programs = FlashProgramCount;
+    uint32_t erased   = erases();
+    fill_log();
+    EXPECT_EQ(FlashProgramCount - programs, 2 * FEE_LOG_RECORDS);
+    EXPECT_EQ(erases(), erased);
+
+    // Writing a byte that did not change costs nothing
+    write(0, shadow[0]);
+    EXPECT_EQ(FlashProgramCount - programs, 2 * FEE_LOG_RECORDS);
+
+    // The next write finds the log full and compacts into the other bank
+    write(100, ~shadow[100]);
+    EXPECT_EQ(erases(), erased + FEE_BANK_PAGES);
+    reboot();
+    expect_shadow();
+}
+
+TEST_F(EepromStm32, SurvivesManyCompactions) {
+    std::mt19937 rng(1);
+    for (uint32_t i = 0; i < 10 * FEE_LOG_RECORDS; i++) {
+        write(rng() % FEE_DENSITY_BYTES, rng());
+    }
+    expect_shadow();
+    reboot();
+    expect_shadow();
+}
+
+TEST_F(EepromStm32, EraseBlanksEverything) {
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES; i += 7) {
+        write(i, i);
+    }
+    EEPROM_Erase();
+    shadow.assign(FEE_DENSITY_BYTES, 0xFF);
+    expect_shadow();
+    reboot();
+    expect_shadow();
+}
+
+TEST_F(EepromStm32, ResetDuringAWriteLosesOnlyThatWrite) {
+    write(10, 0x11);
+    for (int32_t operations = 0; operations < 2; operations++) {
+        FlashFailAfter = operations;
+        EEPROM_WriteDataByte(10, 0x22);
+        reboot();
+        expect_shadow();
+    }
+    // The torn records are skipped, later writes still land
+    write(10, 0x33);
+    reboot();
+    expect_shadow();
+}
+
+TEST_F(EepromStm32, ResetDuringACompactionKeepsOneBankValid) {
+    for (int32_t operations = 0; operations < FEE_BANK_PAGES + FEE_DENSITY_BYTES / 2 + 2; operations += 7) {
+        compact();
+        fill_log();
+
+        // The log is full: this write compacts, and the reset interrupts it
+        uint16_t address = operations % FEE_DENSITY_BYTES;
+        uint8_t  value   = ~shadow[address];
+        FlashFailAfter   = operations;
+        EEPROM_WriteDataByte(address, value);
+        reboot();
+
+        uint8_t read = EEPROM_ReadDataByte(address);
+        EXPECT_TRUE(read == value || read == shadow[address]);
+        shadow[address] = read;
+        expect_shadow();
+    }
+}
+
+TEST_F(EepromStm32, MigratesTheOldLayout) {
+    // The old layout kept byte n in the low half of the half-word at 2n
+    uint32_t base  = FEE_LEGACY_ADDRESS - FEE_PAGE_BASE_ADDRESS;
+    uint16_t bytes = std::min<uint32_t>({FEE_DENSITY_BYTES, FEE_LEGACY_BYTES, (FEE_LEGACY_BANK + 1) * FEE_BANK_SIZE / 2 - base / 2});
+    memset(FlashBuf, 0xFF, sizeof(FlashBuf));
+    for (uint16_t i = 0; i < bytes; i += 3) {
+        FlashBuf[base + i * 2]     = i & 0xFF;
+        FlashBuf[base + i * 2 + 1] = 0x00;
+        shadow[i]                  = i & 0xFF;
+    }
+    reboot();
+    expect_shadow();
+    reboot();
+    expect_shadow();
+
+    // and survive the next compaction, into the pages the old layout used
+    compact();
+    reboot();
+    expect_shadow();
+}
+
+TEST_F(EepromStm32, Endurance) {
+    // Keymap edits and lighting tweaks, spread over the first kilobyte
+    const uint32_t writes = 100000;
+    std::mt19937   rng(3);
+    for (uint32_t i = 0; i < writes; i++) {
+        write(rng() % 1024, rng());
+    }
+    expect_shadow();
+
+    // Every page is erased once every two compactions, one compaction per full log
+    uint32_t expected = writes / (2 * FEE_LOG_RECORDS) + 1;
+    EXPECT_LE(max_page_erases(), expected);
+
+    // The old layout erased a page on nearly every write, with 10k erase cycles
+    // per page it wore out after about 10k writes to the same page.
+    printf("%u writes: %u page erases, at most %u per page, %.1f writes per erase of a page\n", writes, erases(), max_page_erases(), (double)writes / max_page_erases());
+}
+
+TEST_F(EepromStm32, InitCost) {
+    // Worst case: a full log to replay
+    fill_log();
+
+    const int rounds = 1000;
+    auto      start  = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        EEPROM_Init();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    expect_shadow();
+
+    printf("EEPROM_Init reads %u bytes of flash (%u byte image, %u log records), %.2f us on the host\n", (unsigned)(FEE_LOG_OFFSET + FEE_LOG_RECORDS * FEE_LOG_RECORD_SIZE), (unsigned)FEE_DENSITY_BYTES, (unsigned)FEE_LOG_RECORDS, elapsed / 1000.0 / rounds);
+}
@@ -0,0 +1,81 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "eeprom_stm32.h"
+
+/* Simulated flash for host tests of the EEPROM emulation. Like the real
+ * thing, erasing sets a page to 0xFF and a half-word can only be programmed
+ * while it is erased. FlashFailAfter makes the flash stop working after that
+ * many more operations, which looks the same as a reset in the middle of a
+ * sequence of operations.
+ */
+
+uint8_t  FlashBuf[FEE_DENSITY_PAGES * FEE_PAGE_SIZE];
+uint32_t FlashEraseCount[FEE_DENSITY_PAGES];
+uint32_t FlashProgramCount;
+int32_t  FlashFailAfter = -1;
+
+static bool flash_operation_allowed(void) {
+    if (FlashFailAfter == 0) {
+        return false;
+    }
+    if (FlashFailAfter > 0) {
+        FlashFailAfter--;
+    }
+    return true;
+}
+
+FLASH_Status FLASH_WaitForLastOperation(uint32_t Timeout) { return FLASH_COMPLETE; }
+
+FLASH_Status FLASH_ErasePage(uint32_t Page_Address) {
+    uint32_t offset = Page_Address - FEE_PAGE_BASE_ADDRESS;
+
+    if (Page_Address < FEE_PAGE_BASE_ADDRESS || offset >= sizeof(FlashBuf) || offset % FEE_PAGE_SIZE != 0) {
+        return FLASH_BAD_ADDRESS;
+    }
+    if (!flash_operation_allowed()) {
+        return FLASH_TIMEOUT;
+    }
+    memset(&FlashBuf[offset], 0xFF, FEE_PAGE_SIZE);
+    FlashEraseCount[offset / FEE_PAGE_SIZE]++;
+    return FLASH_COMPLETE;
+}
+
+FLASH_Status FLASH_ProgramHalfWord(uint32_t Address, uint16_t Data) {
+    uint32_t offset = Address - FEE_PAGE_BASE_ADDRESS;
+
+    if (Address < FEE_PAGE_BASE_ADDRESS || offset >= sizeof(FlashBuf) || offset % 2 != 0) {
+        return FLASH_BAD_ADDRESS;
+    }
+    if (FlashBuf[offset] != 0xFF || FlashBuf[offset + 1] != 0xFF) {
+        return FLASH_ERROR_PG;
+    }
+    if (!flash_operation_allowed()) {
+        return FLASH_TIMEOUT;
+    }
+    FlashBuf[offset]     = Data & 0xFF;
+    FlashBuf[offset + 1] = Data >> 8;
+    FlashProgramCount++;
+    return FLASH_COMPLETE;
+}
+
+void FLASH_Unlock(void) {}
+
+void FLASH_Lock(void) {}
+
+void FLASH_ClearFlag(uint32_t FLASH_FLAG) {}
@@ -0,0 +1,146 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <array>
+#include <vector>
+
+extern "C" {
+#include "report_queue.h"
+}
+
+typedef std::array<uint8_t, 8> keys_t;   // mods, reserved and six keys
+typedef std::array<uint8_t, 5> mouse_t;  // buttons, x, y, v and h
+
+REPORT_QUEUE(queue, 8);
+
+static keys_t keys(uint8_t key1 = 0, uint8_t key2 = 0) { return {0, 0, key1, key2, 0, 0, 0, 0}; }
+
+class ReportQueue : public ::testing::Test {
+   public:
+    ReportQueue() {
+        report_queue_clear(&queue);
+        report_queue_stats = {};
+    }
+
+    bool push(const keys_t &report) { return report_queue_push(&queue, REPORT_QUEUE_KEYS, report.data(), report.size()); }
+    bool push(const mouse_t &report) { return report_queue_push(&queue, REPORT_QUEUE_MOUSE, report.data(), report.size()); }
+
+    // Pops every queued report
+    template <typename T>
+    std::vector<T> drain() {
+        std::vector<T> reports;
+        uint8_t        size;
+        uint8_t *      report;
+        while ((report = report_queue_peek(&queue, &size))) {
+            EXPECT_EQ(size, sizeof(T));
+            T copy;
+            std::copy(report, report + sizeof(T), copy.begin());
+            reports.push_back(copy);
+            report_queue_pop(&queue);
+        }
+        return reports;
+    }
+};
+
+TEST_F(ReportQueue, KeepsEveryKeyOfAString) {
+    // SEND_STRING("abc") with the host not polling
+    EXPECT_TRUE(push(keys(4)));
+    EXPECT_TRUE(push(keys()));
+    EXPECT_TRUE(push(keys(5)));
+    EXPECT_TRUE(push(keys()));
+    EXPECT_FALSE(push(keys(6)));
+    EXPECT_EQ(queue.count, REPORT_QUEUE_SIZE);
+
+    // the sender waits for the host to take a report, then retries
+    std::vector<keys_t> sent = drain<keys_t>();
+    EXPECT_TRUE(push(keys(6)));
+    EXPECT_TRUE(push(keys()));
+    for (auto report : drain<keys_t>()) {
+        sent.push_back(report);
+    }
+
+    EXPECT_EQ(sent, (std::vector<keys_t>{keys(4), keys(), keys(5), keys(), keys(6), keys()}));
+    EXPECT_EQ(report_queue_stats.dropped, 0);
+}
+
+TEST_F(ReportQueue, FullQueueStillMergesRepeats) {
+    for (uint8_t i = 0; i < REPORT_QUEUE_SIZE; i++) {
+        EXPECT_EQ(report_queue_free(&queue), REPORT_QUEUE_SIZE - i);
+        EXPECT_TRUE(push(keys(4 + i)));
+    }
+    EXPECT_EQ(report_queue_free(&queue), 0);
+    EXPECT_TRUE(push(keys(4 + REPORT_QUEUE_SIZE - 1)));
+    EXPECT_FALSE(push(keys(40)));
+    EXPECT_EQ(drain<keys_t>().back(), keys(4 + REPORT_QUEUE_SIZE - 1));
+}
+
+TEST_F(ReportQueue, DropsRepeatedStates) {
+    push(keys(4));
+    push(keys(4));
+    EXPECT_EQ(drain<keys_t>(), std::vector<keys_t>{keys(4)});
+    EXPECT_EQ(report_queue_stats.merged, 1);
+}
+
+TEST_F(ReportQueue, ReleaseReplacesAQueuedRelease) {
+    push(keys(4));
+    push(keys(4, 5));
+    push(keys(4));
+    push(keys());
+    EXPECT_EQ(drain<keys_t>(), (std::vector<keys_t>{keys(4), keys(4, 5), keys()}));
+}
+
+TEST_F(ReportQueue, NeverMergesPresses) {
+    push(keys());
+    push(keys(4));
+    push(keys(4, 5));
+    EXPECT_EQ(drain<keys_t>(), (std::vector<keys_t>{keys(), keys(4), keys(4, 5)}));
+    EXPECT_EQ(report_queue_stats.merged, 0);
+}
+
+TEST_F(ReportQueue, LeavesTheReportBeingSentAlone) {
+    push(keys(4, 5));
+    push(keys(4));
+    queue.in_flight = true;
+    report_queue_pop(&queue);
+    queue.in_flight = true;
+
+    // keys(4) is on its way to the host, so the release is queued after it
+    push(keys());
+    EXPECT_EQ(drain<keys_t>(), (std::vector<keys_t>{keys(4), keys()}));
+}
+
+TEST_F(ReportQueue, AddsUpMouseMovement) {
+    push(mouse_t{1, 10, (uint8_t)-3, 0, 0});
+    push(mouse_t{1, 5, (uint8_t)-4, 1, 0});
+    EXPECT_EQ(drain<mouse_t>(), std::vector<mouse_t>{(mouse_t{1, 15, (uint8_t)-7, 1, 0})});
+}
+
+TEST_F(ReportQueue, KeepsMouseButtonChangesAndLargeMovement) {
+    push(mouse_t{0, 10, 0, 0, 0});
+    push(mouse_t{1, 10, 0, 0, 0});
+    push(mouse_t{1, 120, 0, 0, 0});
+    EXPECT_EQ(drain<mouse_t>().size(), 3);
+}
+
+TEST_F(ReportQueue, KeepsExtraUsagesApart) {
+    uint8_t up[3]   = {3, 0xE9, 0};
+    uint8_t none[3] = {3, 0, 0};
+    report_queue_push(&queue, REPORT_QUEUE_EXTRA, up, sizeof(up));
+    report_queue_push(&queue, REPORT_QUEUE_EXTRA, none, sizeof(none));
+    report_queue_push(&queue, REPORT_QUEUE_EXTRA, none, sizeof(none));
+    EXPECT_EQ(queue.count, 2);
+}
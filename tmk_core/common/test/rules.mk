@@ -0,0 +1,15 @@
+eeprom_stm32_DEFS := -DFLASH_STM32_MOCKED -DEEPROM_EMU_STM32F303xC
+eeprom_stm32_INC := $(TMK_PATH)/common/chibios
+eeprom_stm32_SRC :=\
+	$(TMK_PATH)/common/test/eeprom_stm32_tests.cpp \
+	$(TMK_PATH)/common/test/flash_stm32.c \
+	$(TMK_PATH)/common/chibios/eeprom_stm32.c
+
+eeprom_stm32_f103_DEFS := -DFLASH_STM32_MOCKED -DEEPROM_EMU_STM32F103xB
+eeprom_stm32_f103_INC := $(TMK_PATH)/common/chibios
+eeprom_stm32_f103_SRC := $(eeprom_stm32_SRC)
+
+report_queue_INC := $(TMK_PATH)/protocol
+report_queue_SRC :=\
+	$(TMK_PATH)/common/test/report_queue_tests.cpp \
+	$(TMK_PATH)/protocol/report_queue.c
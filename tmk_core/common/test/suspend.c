@@ -13,3 +13,8 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+
+#include <stdbool.h>
+#include "suspend.h"
+
+__attribute__((weak)) bool suspend_idle_sleep(void) { return false; }
@@ -0,0 +1,4 @@
+TEST_LIST +=\
+	eeprom_stm32\
+	eeprom_stm32_f103\
+	report_queue
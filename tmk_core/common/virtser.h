@@ -7,4 +7,9 @@ void virtser_recv(const uint8_t ch);
 /* Call this to send a character over the Virtual Serial Device */
 void virtser_send(const uint8_t byte);
 
+/* Call this to send several characters at once. They are written in a
+ * single transfer, so a packet isn't split up by the USB stack.
+ */
+void virtser_send_buffer(const uint8_t *data, uint16_t length);
+
 #endif
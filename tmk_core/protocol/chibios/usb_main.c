@@ -40,6 +40,7 @@
 #include "wait.h"
 #include "usb_descriptor.h"
 #include "usb_driver.h"
+#include "report_queue.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -68,6 +69,64 @@ static virtual_timer_t keyboard_idle_timer;
 static void            keyboard_idle_timer_cb(void *arg);
 
 report_keyboard_t keyboard_report_sent = {{0}};
+
+/* Reports waiting for their endpoint, drained from the IN callbacks */
+#ifndef KEYBOARD_SHARED_EP
+REPORT_QUEUE(keyboard_queue, KEYBOARD_REPORT_SIZE);
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+REPORT_QUEUE(mouse_queue, sizeof(report_mouse_t));
+#endif
+#ifdef SHARED_EP_ENABLE
+REPORT_QUEUE(shared_queue, sizeof(report_keyboard_t));
+#endif
+#ifdef KEYBOARD_SHARED_EP
+#    define keyboard_queue shared_queue
+#endif
+#ifdef MOUSE_SHARED_EP
+#    define mouse_queue shared_queue
+#endif
+
+/* Starts transmitting the oldest queued report if the endpoint is idle
+ * (called in locked state) */
+static void report_queue_startI(USBDriver *usbp, usbep_t ep, report_queue_t *queue) {
+    uint8_t  size;
+    uint8_t *report;
+
+    if (usbGetDriverStateI(usbp) != USB_ACTIVE || usbGetTransmitStatusI(usbp, ep) || !(report = report_queue_peek(queue, &size))) {
+        return;
+    }
+    queue->in_flight = true;
+    usbStartTransmitI(usbp, ep, report, size);
+}
+
+/* Queues a report and starts sending it if the endpoint is idle. When the
+ * queue is full the report waits for the endpoint to make room, like sending
+ * did before reports were queued, rather than losing a key change. Returns
+ * false if it had to be dropped (called in locked state, not from ISR) */
+static bool report_queue_sendS(usbep_t ep, report_queue_t *queue, uint8_t type, const void *report, uint8_t size, sysinterval_t timeout) {
+    while (!report_queue_push(queue, type, report, size)) {
+        report_queue_startI(&USB_DRIVER, ep, queue);
+        /* Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
+        if (!usbGetTransmitStatusI(&USB_DRIVER, ep) || osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[ep]->in_state->thread, timeout) == MSG_TIMEOUT || usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+            report_queue_stats.dropped++;
+            return false;
+        }
+    }
+    report_queue_startI(&USB_DRIVER, ep, queue);
+    return true;
+}
+
+/* An IN transfer on the endpoint completed (called from ISR, unlocked state) */
+static void report_queue_sent(USBDriver *usbp, usbep_t ep, report_queue_t *queue) {
+    osalSysLockFromISR();
+    if (queue->in_flight) {
+        report_queue_pop(queue);
+    }
+    report_queue_startI(usbp, ep, queue);
+    osalSysUnlockFromISR();
+}
+
 #ifdef MOUSE_ENABLE
 report_mouse_t mouse_report_blank = {0};
 #endif /* MOUSE_ENABLE */
@@ -304,12 +363,15 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
             /* Enable the endpoints specified into the configuration. */
 #ifndef KEYBOARD_SHARED_EP
             usbInitEndpointI(usbp, KEYBOARD_IN_EPNUM, &kbd_ep_config);
+            report_queue_clear(&keyboard_queue);
 #endif
 #if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
             usbInitEndpointI(usbp, MOUSE_IN_EPNUM, &mouse_ep_config);
+            report_queue_clear(&mouse_queue);
 #endif
 #ifdef SHARED_EP_ENABLE
             usbInitEndpointI(usbp, SHARED_IN_EPNUM, &shared_ep_config);
+            report_queue_clear(&shared_queue);
 #endif
             for (int i = 0; i < NUM_USB_DRIVERS; i++) {
                 usbInitEndpointI(usbp, drivers.array[i].config.bulk_in, &drivers.array[i].in_ep_config);
@@ -565,11 +627,7 @@ void init_usb_driver(USBDriver *usbp) {
  */
 /* keyboard IN callback hander (a kbd report has made it IN) */
 #ifndef KEYBOARD_SHARED_EP
-void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
-    (void)usbp;
-    (void)ep;
-}
+void kbd_in_cb(USBDriver *usbp, usbep_t ep) { report_queue_sent(usbp, ep, &keyboard_queue); }
 #endif
 
 /* start-of-frame handler
@@ -597,7 +655,7 @@ static void keyboard_idle_timer_cb(void *arg) {
     if (keyboard_idle && keyboard_protocol) {
 #endif /* NKRO_ENABLE */
         /* TODO: are we sure we want the KBD_ENDPOINT? */
-        if (!usbGetTransmitStatusI(usbp, KEYBOARD_IN_EPNUM)) {
+        if (!usbGetTransmitStatusI(usbp, KEYBOARD_IN_EPNUM) && !keyboard_queue.count) {
             usbStartTransmitI(usbp, KEYBOARD_IN_EPNUM, (uint8_t *)&keyboard_report_sent, KEYBOARD_EPSIZE);
         }
         /* rearm the timer */
@@ -612,7 +670,17 @@ static void keyboard_idle_timer_cb(void *arg) {
 /* LED status */
 uint8_t keyboard_leds(void) { return keyboard_led_stats; }
 
-/* prepare and start sending a report IN
+/* free slots in the queue send_keyboard() will use next */
+uint8_t host_keyboard_queue_free(void) {
+#ifdef NKRO_ENABLE
+    if (keymap_config.nkro && keyboard_protocol) {
+        return report_queue_free(&shared_queue);
+    }
+#endif
+    return report_queue_free(&keyboard_queue);
+}
+
+/* queue a report and start sending it if the endpoint is idle
  * not callable from ISR or locked state */
 void send_keyboard(report_keyboard_t *report) {
     osalSysLock();
@@ -622,50 +690,15 @@ void send_keyboard(report_keyboard_t *report) {
 
 #ifdef NKRO_ENABLE
     if (keymap_config.nkro && keyboard_protocol) { /* NKRO protocol */
-        /* need to wait until the previous packet has made it through */
-        /* can rewrite this using the synchronous API, then would wait
-         * until *after* the packet has been transmitted. I think
-         * this is more efficient */
-        /* busy wait, should be short and not very common */
-        if (usbGetTransmitStatusI(&USB_DRIVER, SHARED_IN_EPNUM)) {
-            /* Need to either suspend, or loop and call unlock/lock during
-             * every iteration - otherwise the system will remain locked,
-             * no interrupts served, so USB not going through as well.
-             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-            osalThreadSuspendS(&(&USB_DRIVER)->epc[SHARED_IN_EPNUM]->in_state->thread);
-
-            /* after osalThreadSuspendS returns USB status might have changed */
-            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-                goto unlock;
-            }
-        }
-        usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)report, sizeof(struct nkro_report));
+        report_queue_sendS(SHARED_IN_EPNUM, &shared_queue, REPORT_QUEUE_BITMAP, report, sizeof(struct nkro_report), TIME_INFINITE);
     } else
 #endif /* NKRO_ENABLE */
     {  /* regular protocol */
-        /* need to wait until the previous packet has made it through */
-        /* busy wait, should be short and not very common */
-        if (usbGetTransmitStatusI(&USB_DRIVER, KEYBOARD_IN_EPNUM)) {
-            /* Need to either suspend, or loop and call unlock/lock during
-             * every iteration - otherwise the system will remain locked,
-             * no interrupts served, so USB not going through as well.
-             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-            osalThreadSuspendS(&(&USB_DRIVER)->epc[KEYBOARD_IN_EPNUM]->in_state->thread);
-
-            /* after osalThreadSuspendS returns USB status might have changed */
-            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-                goto unlock;
-            }
-        }
-        uint8_t *data, size;
         if (keyboard_protocol) {
-            data = (uint8_t *)report;
-            size = KEYBOARD_REPORT_SIZE;
+            report_queue_sendS(KEYBOARD_IN_EPNUM, &keyboard_queue, REPORT_QUEUE_KEYS, report, KEYBOARD_REPORT_SIZE, TIME_INFINITE);
         } else { /* boot protocol */
-            data = &report->mods;
-            size = 8;
+            report_queue_sendS(KEYBOARD_IN_EPNUM, &keyboard_queue, REPORT_QUEUE_KEYS, &report->mods, 8, TIME_INFINITE);
         }
-        usbStartTransmitI(&USB_DRIVER, KEYBOARD_IN_EPNUM, data, size);
     }
     keyboard_report_sent = *report;
 
@@ -682,10 +715,7 @@ unlock:
 
 #    ifndef MOUSE_SHARED_EP
 /* mouse IN callback hander (a mouse report has made it IN) */
-void mouse_in_cb(USBDriver *usbp, usbep_t ep) {
-    (void)usbp;
-    (void)ep;
-}
+void mouse_in_cb(USBDriver *usbp, usbep_t ep) { report_queue_sent(usbp, ep, &mouse_queue); }
 #    endif
 
 void send_mouse(report_mouse_t *report) {
@@ -695,17 +725,7 @@ void send_mouse(report_mouse_t *report) {
         return;
     }
 
-    if (usbGetTransmitStatusI(&USB_DRIVER, MOUSE_IN_EPNUM)) {
-        /* Need to either suspend, or loop and call unlock/lock during
-         * every iteration - otherwise the system will remain locked,
-         * no interrupts served, so USB not going through as well.
-         * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[MOUSE_IN_EPNUM]->in_state->thread, TIME_MS2I(10)) == MSG_TIMEOUT) {
-            osalSysUnlock();
-            return;
-        }
-    }
-    usbStartTransmitI(&USB_DRIVER, MOUSE_IN_EPNUM, (uint8_t *)report, sizeof(report_mouse_t));
+    report_queue_sendS(MOUSE_IN_EPNUM, &mouse_queue, REPORT_QUEUE_MOUSE, report, sizeof(report_mouse_t), TIME_MS2I(10));
     osalSysUnlock();
 }
 
@@ -719,11 +739,7 @@ void send_mouse(report_mouse_t *report) { (void)report; }
  */
 #ifdef SHARED_EP_ENABLE
 /* shared IN callback hander */
-void shared_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
-    (void)usbp;
-    (void)ep;
-}
+void shared_in_cb(USBDriver *usbp, usbep_t ep) { report_queue_sent(usbp, ep, &shared_queue); }
 #endif
 
 /* ---------------------------------------------------------
@@ -741,7 +757,7 @@ static void send_extra(uint8_t report_id, uint16_t data) {
 
     report_extra_t report = {.report_id = report_id, .usage = data};
 
-    usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)&report, sizeof(report_extra_t));
+    report_queue_sendS(SHARED_IN_EPNUM, &shared_queue, REPORT_QUEUE_EXTRA, &report, sizeof(report_extra_t), TIME_MS2I(10));
     osalSysUnlock();
 }
 #endif
@@ -854,6 +870,8 @@ void midi_ep_task(void) {
 
 void virtser_send(const uint8_t byte) { chnWrite(&drivers.serial_driver.driver, &byte, 1); }
 
+void virtser_send_buffer(const uint8_t *data, uint16_t length) { chnWrite(&drivers.serial_driver.driver, data, length); }
+
 __attribute__((weak)) void virtser_recv(uint8_t c) {
     // Ignore by default
 }
@@ -16,6 +16,7 @@ endif
 
 LUFA_SRC = lufa.c \
 	   usb_descriptor.c \
+	   report_queue.c \
 	   outputselect.c \
 	   $(LUFA_SRC_USB)
 
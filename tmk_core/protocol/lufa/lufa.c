@@ -51,6 +51,7 @@
 
 #include "usb_descriptor.h"
 #include "lufa.h"
+#include "report_queue.h"
 #include "quantum.h"
 #include <util/atomic.h>
 #include "outputselect.h"
@@ -92,6 +93,23 @@ static uint8_t keyboard_led_stats = 0;
 
 static report_keyboard_t keyboard_report_sent;
 
+/* Reports waiting for their endpoint */
+#ifndef KEYBOARD_SHARED_EP
+REPORT_QUEUE(keyboard_queue, KEYBOARD_REPORT_SIZE);
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+REPORT_QUEUE(mouse_queue, sizeof(report_mouse_t));
+#endif
+#ifdef SHARED_EP_ENABLE
+REPORT_QUEUE(shared_queue, sizeof(report_keyboard_t));
+#endif
+#ifdef KEYBOARD_SHARED_EP
+#    define keyboard_queue shared_queue
+#endif
+#ifdef MOUSE_SHARED_EP
+#    define mouse_queue shared_queue
+#endif
+
 /* Host driver */
 static uint8_t keyboard_leds(void);
 static void    send_keyboard(report_keyboard_t *report);
@@ -370,6 +388,17 @@ void EVENT_USB_Device_StartOfFrame(void) {
 void EVENT_USB_Device_ConfigurationChanged(void) {
     bool ConfigSuccess = true;
 
+    /* Reports queued for a previous configuration are stale */
+#ifndef KEYBOARD_SHARED_EP
+    report_queue_clear(&keyboard_queue);
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+    report_queue_clear(&mouse_queue);
+#endif
+#ifdef SHARED_EP_ENABLE
+    report_queue_clear(&shared_queue);
+#endif
+
     /* Setup Keyboard HID Report Endpoints */
 #ifndef KEYBOARD_SHARED_EP
     ConfigSuccess &= ENDPOINT_CONFIG(KEYBOARD_IN_EPNUM, EP_TYPE_INTERRUPT, ENDPOINT_DIR_IN, KEYBOARD_EPSIZE, ENDPOINT_BANK_SINGLE);
@@ -547,13 +576,78 @@ void EVENT_USB_Device_ControlRequest(void) {
  */
 static uint8_t keyboard_leds(void) { return keyboard_led_stats; }
 
+/** \brief Flush Report Queue
+ *
+ * Writes queued reports for as long as the endpoint has room, without waiting for the host.
+ */
+static void report_queue_flush(uint8_t ep, report_queue_t *queue) {
+    uint8_t  size;
+    uint8_t *report;
+
+    if (USB_DeviceState != DEVICE_STATE_Configured) return;
+
+    Endpoint_SelectEndpoint(ep);
+    while (Endpoint_IsReadWriteAllowed() && (report = report_queue_peek(queue, &size))) {
+        Endpoint_Write_Stream_LE(report, size, NULL);
+        Endpoint_ClearIN();
+        report_queue_pop(queue);
+    }
+}
+
+/** \brief Send Through Report Queue
+ *
+ * Queues a report and writes what fits. When the queue is full the report waits up to 10ms
+ * for the endpoint, like sending did before reports were queued, rather than losing a key change.
+ */
+static void report_queue_send(uint8_t ep, report_queue_t *queue, uint8_t type, const void *report, uint8_t size) {
+    uint8_t timeout = 255;
+
+    while (!report_queue_push(queue, type, report, size)) {
+        if (USB_DeviceState != DEVICE_STATE_Configured || !--timeout) {
+            report_queue_stats.dropped++;
+            return;
+        }
+        _delay_us(40);
+        report_queue_flush(ep, queue);
+    }
+    report_queue_flush(ep, queue);
+}
+
+/** \brief Report Queue Task
+ *
+ * Sends the reports that did not fit when they were queued.
+ */
+static void report_queue_task(void) {
+#ifndef KEYBOARD_SHARED_EP
+    report_queue_flush(KEYBOARD_IN_EPNUM, &keyboard_queue);
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+    report_queue_flush(MOUSE_IN_EPNUM, &mouse_queue);
+#endif
+#ifdef SHARED_EP_ENABLE
+    report_queue_flush(SHARED_IN_EPNUM, &shared_queue);
+#endif
+}
+
+/** \brief Keyboard Queue Free
+ *
+ * Free slots in the queue send_keyboard() will use next.
+ */
+uint8_t host_keyboard_queue_free(void) {
+#ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        return report_queue_free(&shared_queue);
+    }
+#endif
+    return report_queue_free(&keyboard_queue);
+}
+
 /** \brief Send Keyboard
  *
  * FIXME: Needs doc
  */
 static void send_keyboard(report_keyboard_t *report) {
-    uint8_t timeout = 255;
-    uint8_t where   = where_to_send();
+    uint8_t where = where_to_send();
 
 #ifdef BLUETOOTH_ENABLE
     if (where == OUTPUT_BLUETOOTH || where == OUTPUT_USB_AND_BT) {
@@ -583,30 +677,20 @@ static void send_keyboard(report_keyboard_t *report) {
         return;
     }
 
-    /* Select the Keyboard Report Endpoint */
-    uint8_t ep   = KEYBOARD_IN_EPNUM;
-    uint8_t size = KEYBOARD_REPORT_SIZE;
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
-        ep   = SHARED_IN_EPNUM;
-        size = sizeof(struct nkro_report);
-    }
+        report_queue_send(SHARED_IN_EPNUM, &shared_queue, REPORT_QUEUE_BITMAP, report, sizeof(struct nkro_report));
+    } else
 #endif
-    Endpoint_SelectEndpoint(ep);
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
-
-    /* If we're in Boot Protocol, don't send any report ID or other funky fields */
-    if (!keyboard_protocol) {
-        Endpoint_Write_Stream_LE(&report->mods, 8, NULL);
-    } else {
-        Endpoint_Write_Stream_LE(report, size, NULL);
+    {
+        /* If we're in Boot Protocol, don't send any report ID or other funky fields */
+        if (!keyboard_protocol) {
+            report_queue_send(KEYBOARD_IN_EPNUM, &keyboard_queue, REPORT_QUEUE_KEYS, &report->mods, 8);
+        } else {
+            report_queue_send(KEYBOARD_IN_EPNUM, &keyboard_queue, REPORT_QUEUE_KEYS, report, KEYBOARD_REPORT_SIZE);
+        }
     }
 
-    /* Finalize the stream transfer to send the last packet */
-    Endpoint_ClearIN();
-
     keyboard_report_sent = *report;
 }
 
@@ -616,8 +700,7 @@ static void send_keyboard(report_keyboard_t *report) {
  */
 static void send_mouse(report_mouse_t *report) {
 #ifdef MOUSE_ENABLE
-    uint8_t timeout = 255;
-    uint8_t where   = where_to_send();
+    uint8_t where = where_to_send();
 
 #    ifdef BLUETOOTH_ENABLE
     if (where == OUTPUT_BLUETOOTH || where == OUTPUT_USB_AND_BT) {
@@ -642,18 +725,7 @@ static void send_mouse(report_mouse_t *report) {
         return;
     }
 
-    /* Select the Mouse Report Endpoint */
-    Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
-
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
-
-    /* Write Mouse Report Data */
-    Endpoint_Write_Stream_LE(report, sizeof(report_mouse_t), NULL);
-
-    /* Finalize the stream transfer to send the last packet */
-    Endpoint_ClearIN();
+    report_queue_send(MOUSE_IN_EPNUM, &mouse_queue, REPORT_QUEUE_MOUSE, report, sizeof(report_mouse_t));
 #endif
 }
 
@@ -663,19 +735,10 @@ static void send_mouse(report_mouse_t *report) {
  */
 #ifdef EXTRAKEY_ENABLE
 static void send_extra(uint8_t report_id, uint16_t data) {
-    uint8_t timeout = 255;
-
     if (USB_DeviceState != DEVICE_STATE_Configured) return;
 
     report_extra_t r = {.report_id = report_id, .usage = data};
-    Endpoint_SelectEndpoint(SHARED_IN_EPNUM);
-
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
-
-    Endpoint_Write_Stream_LE(&r, sizeof(report_extra_t), NULL);
-    Endpoint_ClearIN();
+    report_queue_send(SHARED_IN_EPNUM, &shared_queue, REPORT_QUEUE_EXTRA, &r, sizeof(report_extra_t));
 }
 #endif
 
@@ -874,7 +937,14 @@ void virtser_task(void) {
  *
  * FIXME: Needs doc
  */
-void virtser_send(const uint8_t byte) {
+void virtser_send(const uint8_t byte) { virtser_send_buffer(&byte, 1); }
+
+/** \brief Virtual Serial Send Buffer
+ *
+ * Writes length bytes to the CDC IN endpoint and flushes them once, so that
+ * a packet goes out in as few USB transfers as possible.
+ */
+void virtser_send_buffer(const uint8_t *data, uint16_t length) {
     uint8_t timeout = 255;
     uint8_t ep      = Endpoint_GetCurrentEndpoint();
 
@@ -889,7 +959,7 @@ void virtser_send(const uint8_t byte) {
 
         while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
 
-        Endpoint_Write_8(byte);
+        Endpoint_Write_Stream_LE(data, length, NULL);
         CDC_Device_Flush(&cdc_device);
 
         if (Endpoint_IsINReady()) {
@@ -989,6 +1059,7 @@ int main(void) {
 #endif
 
         keyboard_task();
+        report_queue_task();
 
 #ifdef MIDI_ENABLE
         MIDI_Device_USBTask(&USB_MIDI_Interface);
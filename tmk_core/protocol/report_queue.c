@@ -0,0 +1,143 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "report_queue.h"
+#include <string.h>
+
+report_queue_stats_t report_queue_stats;
+
+/* A slot holds the report type, its size and the report itself */
+static uint8_t *report_queue_slot(report_queue_t *queue, uint8_t index) { return queue->buffer + (uint8_t)((queue->head + index) % REPORT_QUEUE_SIZE) * queue->stride; }
+
+/* Whether every key, modifier or button down in a is also down in b */
+static bool report_is_subset(uint8_t type, const uint8_t *a, const uint8_t *b, uint8_t size) {
+    uint8_t bitmap_size = type == REPORT_QUEUE_KEYS ? size - 6 : size;
+
+    for (uint8_t i = 0; i < bitmap_size; i++) {
+        if (a[i] & ~b[i]) {
+            return false;
+        }
+    }
+    for (uint8_t i = bitmap_size; i < size; i++) {
+        if (a[i] && !memchr(b + bitmap_size, a[i], size - bitmap_size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Adds the movement of a mouse report to the queued one, if the buttons
+ * are the same and the sums fit */
+static bool report_merge_mouse(uint8_t *queued, const uint8_t *report, uint8_t size) {
+    uint8_t deltas = size - 4;
+
+    if (memcmp(queued, report, deltas) != 0) {
+        return false;
+    }
+    for (uint8_t i = deltas; i < size; i++) {
+        int16_t sum = (int8_t)queued[i] + (int8_t)report[i];
+        if (sum < -127 || sum > 127) {
+            return false;
+        }
+    }
+    for (uint8_t i = deltas; i < size; i++) {
+        queued[i] += report[i];
+    }
+    return true;
+}
+
+/* Whether the report can be folded into the last queued one. Key and
+ * button reports are states, so a repeated state is dropped, and a release
+ * can replace a queued release as no key change is lost; presses are never
+ * merged, as that could change their order. Mouse movement adds up.
+ */
+static bool report_queue_merge(report_queue_t *queue, uint8_t type, const uint8_t *report, uint8_t size) {
+    uint8_t *tail      = report_queue_slot(queue, queue->count - 1);
+    bool     tail_free = queue->count > 1 || !queue->in_flight;
+
+    if (tail[0] != type || tail[1] != size) {
+        return false;
+    }
+    if (type == REPORT_QUEUE_MOUSE) {
+        return tail_free && report_merge_mouse(tail + 2, report, size);
+    }
+    if (memcmp(tail + 2, report, size) == 0) {
+        return true;
+    }
+    if (type == REPORT_QUEUE_EXTRA || !tail_free || queue->count < 2) {
+        return false;
+    }
+
+    uint8_t *prev = report_queue_slot(queue, queue->count - 2);
+    if (prev[0] == type && prev[1] == size && report_is_subset(type, report, tail + 2, size) && report_is_subset(type, tail + 2, prev + 2, size)) {
+        memcpy(tail + 2, report, size);
+        return true;
+    }
+    return false;
+}
+
+/* Queues a report, or merges it into the last queued one. When the queue is
+ * full and the report can't be merged, nothing is replaced, as that could
+ * lose a key change: false is returned and the caller has to wait for the
+ * endpoint to drain the queue. Not reentrant, callers lock out the code
+ * draining the queue.
+ */
+bool report_queue_push(report_queue_t *queue, uint8_t type, const void *report, uint8_t size) {
+    if (size > queue->stride - 2) {
+        return true;
+    }
+    if (queue->count && report_queue_merge(queue, type, report, size)) {
+        report_queue_stats.merged++;
+        return true;
+    }
+    if (queue->count >= REPORT_QUEUE_SIZE) {
+        return false;
+    }
+
+    uint8_t *slot = report_queue_slot(queue, queue->count++);
+    slot[0]       = type;
+    slot[1]       = size;
+    memcpy(slot + 2, report, size);
+    return true;
+}
+
+/* The oldest queued report, or NULL */
+uint8_t *report_queue_peek(report_queue_t *queue, uint8_t *size) {
+    if (!queue->count) {
+        return NULL;
+    }
+
+    uint8_t *slot = report_queue_slot(queue, 0);
+    *size         = slot[1];
+    return slot + 2;
+}
+
+void report_queue_pop(report_queue_t *queue) {
+    if (queue->count) {
+        queue->head = (queue->head + 1) % REPORT_QUEUE_SIZE;
+        queue->count--;
+    }
+    queue->in_flight = false;
+}
+
+void report_queue_clear(report_queue_t *queue) {
+    queue->head      = 0;
+    queue->count     = 0;
+    queue->in_flight = false;
+}
+
+/* Number of reports that can be queued without waiting or merging */
+uint8_t report_queue_free(const report_queue_t *queue) { return REPORT_QUEUE_SIZE - queue->count; }
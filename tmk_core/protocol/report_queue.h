@@ -0,0 +1,66 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Reports waiting for an IN endpoint, so that sending a report never waits
+ * for the host to poll. Each endpoint has its own queue.
+ */
+#ifndef REPORT_QUEUE_SIZE
+#    define REPORT_QUEUE_SIZE 4
+#endif
+
+#if REPORT_QUEUE_SIZE < 2
+#    error "REPORT_QUEUE_SIZE must be at least 2"
+#endif
+
+/* Report layouts, which decide how a report can be merged with the one
+ * queued before it */
+enum report_queue_type {
+    REPORT_QUEUE_KEYS,    // ends with mods, reserved and six keys
+    REPORT_QUEUE_BITMAP,  // NKRO, every byte is a bitmap
+    REPORT_QUEUE_MOUSE,   // ends with the x, y, v and h deltas
+    REPORT_QUEUE_EXTRA,   // system or consumer usage
+};
+
+typedef struct {
+    uint8_t *buffer;
+    uint8_t  stride;
+    uint8_t  head;
+    uint8_t  count;
+    bool     in_flight;  // the head report is being transmitted
+} report_queue_t;
+
+typedef struct {
+    uint16_t merged;   // reports merged into a queued one without losing a key change
+    uint16_t dropped;  // states that never reached the host, as a queue stayed full
+} report_queue_stats_t;
+
+extern report_queue_stats_t report_queue_stats;
+
+/* Defines a queue for reports of up to report_size bytes */
+#define REPORT_QUEUE(name, report_size)                                        \
+    static uint8_t        name##_buffer[REPORT_QUEUE_SIZE][2 + (report_size)]; \
+    static report_queue_t name = {.buffer = &name##_buffer[0][0], .stride = 2 + (report_size)}
+
+bool     report_queue_push(report_queue_t *queue, uint8_t type, const void *report, uint8_t size);
+uint8_t *report_queue_peek(report_queue_t *queue, uint8_t *size);
+void     report_queue_pop(report_queue_t *queue);
+void     report_queue_clear(report_queue_t *queue);
+uint8_t  report_queue_free(const report_queue_t *queue);